@@ -0,0 +1,115 @@
+/**
+ * @file count_bases_bench.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Micro-benchmark of the base counting functions.
+ * @details Compares count_bases called through std::function against the
+ * templated count_bases_if and the column vote kernel on a synthetic set of
+ * extension reads. Usage: count_bases_bench [num_reads] [read_len] [rounds]
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "bases.h"
+#include "extension.h"
+#include "vote_kernel.h"
+
+
+using std::string;
+
+
+/**
+ * @brief Runs the given function over the extension set and returns the
+ * average time of one call in nanoseconds.
+ */
+template<typename Function>
+double measure(ExtensionSet& extensions, uint32_t rounds, uint64_t *checksum,
+               Function function) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t round = 0; round < rounds; ++round) {
+        *checksum += function(extensions);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end - start).count();
+
+    return static_cast<double>(elapsed) / rounds;
+}
+
+
+int main(int argc, char **argv) {
+    uint32_t num_reads = argc > 1 ? atoi(argv[1]) : 200;
+    uint32_t read_len = argc > 2 ? atoi(argv[2]) : 1000;
+    uint32_t rounds = argc > 3 ? atoi(argv[3]) : 100000;
+
+    std::mt19937 generator(42);
+    const char *alphabet = "ATGC";
+
+    ExtensionSet extensions;
+    for (uint32_t i = 0; i < num_reads; ++i) {
+        string read;
+        for (uint32_t j = 0; j < read_len; ++j) {
+            read.push_back(alphabet[generator() % NUM_BASES]);
+        }
+        extensions.add(i, read.data(), read.size(), false);
+    }
+
+    uint64_t checksum = 0;
+    const char base = 'A';
+
+    double function_ns = measure(extensions, rounds, &checksum,
+        [base](ExtensionSet& extensions) -> uint32_t {
+            auto is_read_eligible = [base](char c) -> bool {
+                return c == base;
+            };
+            return bases::count_bases(extensions,
+                                      bool_predicate(is_read_eligible),
+                                      1).coverage;
+        });
+
+    double template_ns = measure(extensions, rounds, &checksum,
+        [base](ExtensionSet& extensions) -> uint32_t {
+            return bases::count_bases_if(extensions, bases::BaseEquals(base),
+                                         1).coverage;
+        });
+
+    double all_function_ns = measure(extensions, rounds, &checksum,
+        [](ExtensionSet& extensions) -> uint32_t {
+            auto is_read_eligible = [](char c) -> bool { (void) c; return true; };
+            return bases::count_bases(extensions,
+                                      bool_predicate(is_read_eligible),
+                                      0).coverage;
+        });
+
+    double all_template_ns = measure(extensions, rounds, &checksum,
+        [](ExtensionSet& extensions) -> uint32_t {
+            return bases::count_bases_if(extensions, bases::AllReads(),
+                                         0).coverage;
+        });
+
+    bases::VoteBuffer buffer;
+    bases::ColumnVotes votes;
+    double kernel_ns = measure(extensions, rounds, &checksum,
+        [&buffer, &votes](ExtensionSet& extensions) -> uint32_t {
+            bases::count_columns(extensions, &buffer, &votes);
+            return votes.current.coverage + votes.next[0].coverage;
+        });
+
+    printf("reads: %u, rounds: %u, checksum: %llu\n", num_reads, rounds,
+           static_cast<unsigned long long>(checksum));
+    printf("%-36s %10.1f ns\n", "count_bases, std::function, A", function_ns);
+    printf("%-36s %10.1f ns\n", "count_bases_if, BaseEquals", template_ns);
+    printf("%-36s %10.1f ns\n", "count_bases, std::function, all",
+           all_function_ns);
+    printf("%-36s %10.1f ns\n", "count_bases_if, AllReads", all_template_ns);
+    printf("%-36s %10.1f ns\n", "count_columns (both columns)", kernel_ns);
+    printf("vote kernel: %s\n", bases::vote_kernel_name());
+
+    return 0;
+}
@@ -0,0 +1,322 @@
+/**
+ * @file poa_bench.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Benchmark of the POA consensus engines.
+ * @details Cuts windows of the reference genome, collects the segments of the
+ * reads spanning each window and computes their consensus with the native
+ * kernel and, when the cpppoa library has been built, with cpppoa. Reads are
+ * placed on the reference by exact k-mer anchors so the benchmark needs no
+ * external aligner. Reports the time per window and the edit distance of the
+ * consensus to the reference window.
+ * Usage: poa_bench [reference.fasta] [reads.fasta] [num_windows] [window_len]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef BENCH_CPPPOA
+    #include <cpppoa/poa.hpp>
+#endif
+
+#include "base_tables.h"
+#include "edit_distance.h"
+#include "poa_kernel.h"
+
+
+using std::string;
+using std::vector;
+using std::pair;
+
+
+/**
+ * @brief Length of the anchoring k-mers
+ */
+#define ANCHOR_K 15
+
+/**
+ * @brief Minimum number of anchors of a placed read
+ */
+#define MIN_ANCHORS 20
+
+/**
+ * @brief Maximum distance of the outermost anchors to the window ends
+ */
+#define MAX_ANCHOR_GAP 50
+
+/**
+ * @brief Maximum number of read segments per window
+ */
+#define MAX_WINDOW_DEPTH 30
+
+
+/**
+ * @brief Read placed on the reference.
+ */
+struct PlacedRead {
+    string seq;
+    // (read position, reference position) pairs sorted by read position
+    vector<pair<uint32_t, uint32_t>> anchors;
+};
+
+
+vector<string> read_fasta_file(const char *filename) {
+    std::ifstream input(filename);
+    if (!input) {
+        fprintf(stderr, "Unable to open %s\n", filename);
+        exit(1);
+    }
+
+    vector<string> seqs;
+    string line;
+    while (std::getline(input, line)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        if (line[0] == '>') {
+            seqs.emplace_back();
+        } else if (!seqs.empty()) {
+            for (char c : line) {
+                seqs.back().push_back(toupper(c));
+            }
+        }
+    }
+
+    return seqs;
+}
+
+
+// packs the k-mer starting at seq, returns false if it contains an N
+bool pack_kmer(const char *seq, uint32_t *kmer) {
+    *kmer = 0;
+    for (int i = 0; i < ANCHOR_K; ++i) {
+        int code = bases::encode(seq[i]);
+        if (code == BASE_N_IDX) {
+            return false;
+        }
+        *kmer = (*kmer << 2) | code;
+    }
+    return true;
+}
+
+
+string reverse_complement(const string& seq) {
+    string result(seq.rbegin(), seq.rend());
+    for (auto& base : result) {
+        base = bases::complement(base);
+    }
+    return result;
+}
+
+
+// places a read strand by its anchors on the dominant diagonal
+bool place_read(const string& seq,
+                const vector<pair<uint32_t, uint32_t>>& index,
+                PlacedRead *pplaced) {
+    auto& placed = *pplaced;
+    placed.anchors.clear();
+
+    for (uint32_t i = 0; i + ANCHOR_K <= seq.length(); ++i) {
+        uint32_t kmer;
+        if (!pack_kmer(seq.data() + i, &kmer)) {
+            continue;
+        }
+
+        auto range = std::equal_range(index.begin(), index.end(),
+            pair<uint32_t, uint32_t>(kmer, 0),
+            [](const pair<uint32_t, uint32_t>& a,
+               const pair<uint32_t, uint32_t>& b) {
+                return a.first < b.first;
+            });
+
+        // only unique k-mers are used as anchors
+        if (range.second - range.first == 1) {
+            placed.anchors.push_back({i, range.first->second});
+        }
+    }
+
+    if (placed.anchors.size() < MIN_ANCHORS) {
+        return false;
+    }
+
+    vector<int64_t> diagonals;
+    for (auto const& anchor : placed.anchors) {
+        diagonals.push_back((int64_t) anchor.second - anchor.first);
+    }
+
+    std::nth_element(diagonals.begin(),
+                     diagonals.begin() + diagonals.size() / 2,
+                     diagonals.end());
+    int64_t median = diagonals[diagonals.size() / 2];
+    int64_t max_shift = 50 + seq.length() / 10;
+
+    auto off_diagonal = [median, max_shift](
+            const pair<uint32_t, uint32_t>& anchor) {
+        return std::abs((int64_t) anchor.second - anchor.first - median) >
+               max_shift;
+    };
+
+    placed.anchors.erase(std::remove_if(placed.anchors.begin(),
+                                        placed.anchors.end(), off_diagonal),
+                         placed.anchors.end());
+
+    if (placed.anchors.size() < MIN_ANCHORS) {
+        return false;
+    }
+
+    placed.seq = seq;
+    return true;
+}
+
+
+// cuts the segment of the read spanning [start, end) of the reference
+bool cut_segment(const PlacedRead& read, uint32_t start, uint32_t end,
+                 string *psegment) {
+    const pair<uint32_t, uint32_t> *first = nullptr, *last = nullptr;
+    for (auto const& anchor : read.anchors) {
+        if (anchor.second >= start && anchor.second + ANCHOR_K <= end) {
+            if (first == nullptr) {
+                first = &anchor;
+            }
+            last = &anchor;
+        }
+    }
+
+    if (first == nullptr || first->second - start > MAX_ANCHOR_GAP ||
+            end - (last->second + ANCHOR_K) > MAX_ANCHOR_GAP ||
+            first->first < first->second - start) {
+        return false;
+    }
+
+    uint32_t seg_start = first->first - (first->second - start);
+    uint32_t seg_end = last->first + ANCHOR_K + (end - last->second -
+                                                 ANCHOR_K);
+    if (seg_end > read.seq.length() || seg_end <= seg_start) {
+        return false;
+    }
+
+    *psegment = read.seq.substr(seg_start, seg_end - seg_start);
+    return true;
+}
+
+
+template<typename Function>
+void run_engine(const char *name, const vector<vector<string>>& windows,
+                const vector<string>& truth, Function consensus) {
+    double seconds = 0;
+    uint64_t errors = 0, bases = 0;
+
+    for (size_t i = 0; i < windows.size(); ++i) {
+        auto start = std::chrono::steady_clock::now();
+        string result = consensus(windows[i]);
+        auto end = std::chrono::steady_clock::now();
+        seconds += std::chrono::duration<double>(end - start).count();
+
+        edit_distance::PrefixAlignment alignment;
+        uint32_t max_distance = truth[i].length();
+        if (edit_distance::align_prefix(truth[i].data(), truth[i].length(),
+                                        result.data(), result.length(),
+                                        max_distance, &alignment)) {
+            errors += alignment.distance;
+        } else {
+            errors += truth[i].length();
+        }
+        bases += truth[i].length();
+    }
+
+    printf("%-16s %10.2f ms/window %9.3f%% error\n", name,
+           1e3 * seconds / windows.size(), 100.0 * errors / bases);
+}
+
+
+int main(int argc, char **argv) {
+    const char *reference_file = argc > 1 ? argv[1] :
+        "../data/E-Coli/e-coli-MG1655-reference.fasta";
+    const char *reads_file = argc > 2 ? argv[2] :
+        "../data/E-Coli/HighQualityTwoDirectionReads.fasta";
+    uint32_t num_windows = argc > 3 ? atoi(argv[3]) : 50;
+    uint32_t window_len = argc > 4 ? atoi(argv[4]) : 1000;
+
+    string reference = read_fasta_file(reference_file).at(0);
+    vector<string> reads = read_fasta_file(reads_file);
+
+    // sorted k-mer index of the reference
+    vector<pair<uint32_t, uint32_t>> index;
+    for (uint32_t i = 0; i + ANCHOR_K <= reference.length(); ++i) {
+        uint32_t kmer;
+        if (pack_kmer(reference.data() + i, &kmer)) {
+            index.push_back({kmer, i});
+        }
+    }
+    std::sort(index.begin(), index.end());
+
+    vector<PlacedRead> placed;
+    for (auto const& read : reads) {
+        PlacedRead candidate;
+        if (place_read(read, index, &candidate) ||
+            place_read(reverse_complement(read), index, &candidate)) {
+            placed.emplace_back(std::move(candidate));
+        }
+    }
+
+    std::mt19937 generator(42);
+    vector<vector<string>> windows;
+    vector<string> truth;
+
+    for (uint32_t attempt = 0; windows.size() < num_windows &&
+            attempt < 100 * num_windows; ++attempt) {
+        uint32_t start = generator() % (reference.length() - window_len);
+        vector<string> segments;
+
+        for (auto const& read : placed) {
+            string segment;
+            if (segments.size() < MAX_WINDOW_DEPTH &&
+                cut_segment(read, start, start + window_len, &segment)) {
+                segments.emplace_back(std::move(segment));
+            }
+        }
+
+        if (segments.size() >= 3) {
+            windows.emplace_back(std::move(segments));
+            truth.push_back(reference.substr(start, window_len));
+        }
+    }
+
+    uint64_t depth = 0;
+    for (auto const& window : windows) {
+        depth += window.size();
+    }
+
+    printf("%zu of %zu reads placed, %zu windows of %u bp, mean depth "
+           "%.1f\n", placed.size(), reads.size(), windows.size(), window_len,
+           windows.empty() ? 0.0 : (double) depth / windows.size());
+    if (windows.empty()) {
+        return 1;
+    }
+
+    NativePoa kernel;
+    string native_name = string("native/") + poa_kernel_name();
+    run_engine(native_name.c_str(), windows, truth,
+               [&kernel](const vector<string>& sequences) {
+                   return kernel.consensus(sequences);
+               });
+
+#ifdef BENCH_CPPPOA
+    run_engine("cpppoa", windows, truth,
+               [](const vector<string>& sequences) {
+                   return poa_consensus(sequences);
+               });
+#else
+    printf("cpppoa skipped, build lib/poa to include it\n");
+#endif
+
+    return 0;
+}
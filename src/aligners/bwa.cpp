@@ -14,6 +14,7 @@
 
 #include "bwa.h"
 #include "utility.h"
+#include "resources.h"
 
 
 using std::string;
@@ -26,9 +27,11 @@ void BwaAligner::index(const char *filename) {
 
 void BwaAligner::align(const char *reference_file, const char *reads_file,
     const char *sam_file, bool only_primary) {
+    ThreadLease lease(ALIGNER_THREADS, utility::get_concurrency_level());
+
     utility::execute_command(
         "bwa mem -t %d -x %s %s %th %th > %th 2> /dev/null",
-        utility::get_concurrency_level(),
+        lease.threads(),
         tech_type == read_type::PacBio ? "pacbio" : "ont2d",
         only_primary ? "" : "-Y",
         reference_file,
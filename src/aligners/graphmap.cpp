@@ -6,6 +6,7 @@
 
 #include "graphmap.h"
 #include "utility.h"
+#include "resources.h"
 
 
 void GraphMapAligner::index(const char* filename) {
@@ -23,9 +24,11 @@ void GraphMapAligner::align(const char* reference_file,
                             const char* reads_file,
                             const char* sam_file,
                             bool only_primary) {
+    ThreadLease lease(ALIGNER_THREADS, utility::get_concurrency_level());
+
     utility::execute_command(
         "graphmap -v 0 -t %d %s -F 1 -a anchor -r %th -d %th -o %th",
-        utility::get_concurrency_level(),
+        lease.threads(),
         only_primary ? "" : "-Z",
         reference_file,
         reads_file,
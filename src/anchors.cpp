@@ -0,0 +1,49 @@
+/**
+ * @file anchors.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the AnchorSet class.
+ * @details Implementation file for the AnchorSet class. Anchors are the ends
+ * of the extended contigs used to find overlapping contigs.
+ */
+#include <fstream>
+#include <vector>
+
+#include "anchors.h"
+
+
+AnchorSet::AnchorSet(const vector<Contig*>& contigs) {
+    anchors_.reserve(2 * contigs.size());
+
+    for (uint32_t i = 0; i < contigs.size(); ++i) {
+        const Contig *contig = contigs[i];
+
+        anchors_.push_back({i, LEFT, &contig->left_id(),
+                            contig->anchor_slice(LEFT)});
+        anchors_.push_back({i, RIGHT, &contig->right_id(),
+                            contig->anchor_slice(RIGHT)});
+    }
+}
+
+
+void AnchorSet::write(std::ostream& out) const {
+    for (auto const& anchor : anchors_) {
+        utility::write_fasta(out, utility::CharString_to_string(*anchor.id),
+                             {anchor.slice});
+    }
+}
+
+
+void AnchorSet::write(const char *filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        utility::exit_with_message("Could not open file %s", filename);
+    }
+
+    write(out);
+
+    if (!out) {
+        utility::exit_with_message("Could not write file %s", filename);
+    }
+}
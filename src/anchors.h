@@ -0,0 +1,129 @@
+/**
+ * @file anchors.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the AnchorSet class.
+ * @details Header file for the AnchorSet class. Anchors are the ends of the
+ * extended contigs used to find overlapping contigs. The anchor set refers to
+ * the sequences of the contigs instead of copying the anchor bases.
+ */
+#ifndef ANCHORS_H
+#define ANCHORS_H
+
+#include <seqan/sequence.h>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+#include "contig.h"
+#include "utility.h"
+
+
+using std::vector;
+using seqan::CharString;
+
+
+/**
+ * @brief View of a single contig anchor.
+ */
+struct AnchorView {
+    /**
+     * @brief Index of the contig the anchor was created from.
+     */
+    uint32_t contig_idx;
+
+    /**
+     * @brief Side of the contig the anchor was created from, in the
+     * orientation of the contig when the anchor was created.
+     */
+    ContigSide side;
+
+    /**
+     * @brief Anchor ID, the contig ID followed by L or R.
+     */
+    const CharString *id;
+
+    /**
+     * @brief Anchor bases, a slice of the contig sequence.
+     */
+    SequenceSlice slice;
+
+
+    /**
+     * @brief Getter for the anchor length.
+     * @return Number of bases in the anchor.
+     */
+    uint32_t length() const { return slice.end - slice.begin; }
+};
+
+
+/**
+ * @brief Set of the anchors of all contigs.
+ * @details The set holds two anchors per contig, the left anchor of contig i
+ * at index 2 * i and the right one at index 2 * i + 1. Anchors keep referring
+ * to the same bases when contigs are reverse complemented afterwards, the
+ * contigs must outlive the set.
+ */
+class AnchorSet {
+ public:
+    /**
+     * @brief AnchorSet class constructor.
+     *
+     * @param contigs contigs to create the anchors from
+     */
+    explicit AnchorSet(const vector<Contig*>& contigs);
+
+
+    /**
+     * @brief Getter for the number of anchors.
+     * @return Number of anchors in the set.
+     */
+    uint32_t size() const { return anchors_.size(); }
+
+
+    /**
+     * @brief Access to an anchor.
+     *
+     * @param idx index of the anchor
+     * @return View of the anchor.
+     */
+    const AnchorView& operator[](uint32_t idx) const { return anchors_[idx]; }
+
+
+    /**
+     * @brief Iterator to the first anchor.
+     */
+    vector<AnchorView>::const_iterator begin() const {
+        return anchors_.begin();
+    }
+
+
+    /**
+     * @brief Iterator past the last anchor.
+     */
+    vector<AnchorView>::const_iterator end() const { return anchors_.end(); }
+
+
+    /**
+     * @brief Streams all anchors in FASTA format.
+     *
+     * @param out output stream
+     */
+    void write(std::ostream& out) const;
+
+
+    /**
+     * @brief Writes all anchors to a FASTA file.
+     *
+     * @param filename path to the output file
+     */
+    void write(const char *filename) const;
+
+ private:
+    // views of all anchors
+    vector<AnchorView> anchors_;
+};
+
+
+#endif  // ANCHORS_H
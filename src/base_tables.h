@@ -0,0 +1,126 @@
+/**
+ * @file base_tables.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Compile time lookup tables for nucleotide encoding and complement.
+ * @details Compile time lookup tables for nucleotide encoding and complement.
+ * Every one of the 256 character values has an entry, so lookups never branch
+ * and never fail. Bases A, T, G and C are encoded as 0, 1, 2 and 3, while N,
+ * the IUPAC ambiguity codes and any other character are encoded as
+ * BASE_N_IDX. Complements preserve case and map IUPAC codes to their IUPAC
+ * complement, other characters are complemented to N.
+ */
+#ifndef BASE_TABLES_H
+#define BASE_TABLES_H
+
+#include <cstdint>
+
+
+/**
+ * @brief Code of N, ambiguous and invalid bases
+ */
+#define BASE_N_IDX 4
+
+/**
+ * @brief Number of different base codes, A, T, G, C and N
+ */
+#define NUM_BASE_CODES 5
+
+/**
+ * @brief Size of a table indexed by a character
+ */
+#define CHAR_TABLE_SIZE 256
+
+
+// expand f(i) for 256 consecutive values of i
+#define TABLE_4(f, i) f(i), f(i + 1), f(i + 2), f(i + 3)
+#define TABLE_16(f, i) TABLE_4(f, i), TABLE_4(f, i + 4), \
+    TABLE_4(f, i + 8), TABLE_4(f, i + 12)
+#define TABLE_64(f, i) TABLE_16(f, i), TABLE_16(f, i + 16), \
+    TABLE_16(f, i + 32), TABLE_16(f, i + 48)
+#define TABLE_256(f) TABLE_64(f, 0), TABLE_64(f, 64), \
+    TABLE_64(f, 128), TABLE_64(f, 192)
+
+
+namespace bases {
+
+
+/**
+ * @brief Returns the code of the given character.
+ *
+ * @param c character value in range [0, 256)
+ * @return base code in range [0, NUM_BASE_CODES)
+ */
+constexpr uint8_t base_code(int c) {
+    return (c == 'A' || c == 'a') ? 0 :
+           (c == 'T' || c == 't') ? 1 :
+           (c == 'G' || c == 'g') ? 2 :
+           (c == 'C' || c == 'c') ? 3 : BASE_N_IDX;
+}
+
+
+/**
+ * @brief Returns the complement of the given character.
+ *
+ * @param c character value in range [0, 256)
+ * @return complement of an upper or lower case nucleotide or IUPAC code,
+ * N for any other character
+ */
+constexpr char base_complement(int c) {
+    return c == 'A' ? 'T' : c == 'T' ? 'A' : c == 'G' ? 'C' : c == 'C' ? 'G' :
+           c == 'a' ? 't' : c == 't' ? 'a' : c == 'g' ? 'c' : c == 'c' ? 'g' :
+           c == 'U' ? 'A' : c == 'u' ? 'a' :
+           c == 'R' ? 'Y' : c == 'Y' ? 'R' : c == 'r' ? 'y' : c == 'y' ? 'r' :
+           c == 'K' ? 'M' : c == 'M' ? 'K' : c == 'k' ? 'm' : c == 'm' ? 'k' :
+           c == 'B' ? 'V' : c == 'V' ? 'B' : c == 'b' ? 'v' : c == 'v' ? 'b' :
+           c == 'D' ? 'H' : c == 'H' ? 'D' : c == 'd' ? 'h' : c == 'h' ? 'd' :
+           c == 'S' ? 'S' : c == 'W' ? 'W' : c == 's' ? 's' : c == 'w' ? 'w' :
+           c == 'n' ? 'n' : 'N';
+}
+
+
+/**
+ * @brief Base code of every character
+ */
+constexpr uint8_t BASE_CODES[CHAR_TABLE_SIZE] = { TABLE_256(base_code) };
+
+/**
+ * @brief Complement of every character
+ */
+constexpr char BASE_COMPLEMENTS[CHAR_TABLE_SIZE] = {
+    TABLE_256(base_complement)
+};
+
+/**
+ * @brief Base of every base code
+ */
+constexpr char CODE_BASES[NUM_BASE_CODES] = { 'A', 'T', 'G', 'C', 'N' };
+
+
+/**
+ * @brief Returns the code of the given base.
+ */
+inline uint8_t encode(char base) {
+    return BASE_CODES[static_cast<uint8_t>(base)];
+}
+
+
+/**
+ * @brief Returns the complement of the given base.
+ */
+inline char complement(char base) {
+    return BASE_COMPLEMENTS[static_cast<uint8_t>(base)];
+}
+
+
+}  // namespace bases
+
+
+#undef TABLE_4
+#undef TABLE_16
+#undef TABLE_64
+#undef TABLE_256
+
+
+#endif  // BASE_TABLES_H
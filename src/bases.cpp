@@ -19,15 +19,36 @@
 namespace bases {
 
 
+VoteMode vote_mode = UNWEIGHTED_VOTE;
+
+
+void set_vote_mode(VoteMode mode) {
+    vote_mode = mode;
+}
+
+
+VoteMode get_vote_mode() {
+    return vote_mode;
+}
+
+
 BasesCounter::BasesCounter() {
-    std::memset(count, 0, NUM_BASES * sizeof(uint32_t));
+    std::memset(count, 0, sizeof(count));
+    std::memset(score, 0, sizeof(score));
     coverage = 0;
     max_idx = 0;
 }
 
 
 void BasesCounter::digest_base(char base) {
-    count[utility::base_to_idx(base)]++;
+    digest_base(base, 1);
+}
+
+
+void BasesCounter::digest_base(char base, uint32_t weight) {
+    uint8_t idx = bases::encode(base);
+    count[idx]++;
+    score[idx] += weight;
 }
 
 
@@ -38,40 +59,34 @@ void BasesCounter::refresh_stats() {
     for (uint32_t index = 1; index < NUM_BASES; ++index) {
         coverage += count[index];
 
-        if (count[index] > count[max_idx]) {
+        if (score[index] > score[max_idx]) {
             max_idx = index;
         }
     }
 }
 
 
-BasesCounter count_bases(const vector<shared_ptr<Extension>>& extensions,
-                        bool_predicate is_read_eligible,
-                        int offset) {
-    BasesCounter counter;
+template BasesCounter count_bases_if<AllReads>(
+    const ExtensionSet&, const AllReads&, int);
+template BasesCounter count_bases_if<BaseEquals>(
+    const ExtensionSet&, const BaseEquals&, int);
 
-    for (size_t j = 0; j < extensions.size(); ++j) {
-        auto& extension = extensions[j];
 
-        if (!extension->is_droped) {
-            auto& seq = extension->seq();
-            uint32_t position = extension->curr_pos();
+BasesCounter count_bases(const ExtensionSet& extensions,
+                         bool_predicate is_read_eligible,
+                         int offset) {
+    return count_bases_if(extensions, is_read_eligible, offset);
+}
 
-            if (position + offset < seq.length() &&
-                is_read_eligible(seq[position])) {
-                counter.digest_base(seq[position + offset]);
-            }
-        }
-    }
 
-    counter.refresh_stats();
-    return counter;
+BasesCounter count_bases(const ExtensionSet& extensions) {
+    return count_bases_if(extensions, AllReads(), 0);
 }
 
 
-BasesCounter count_bases(const vector<shared_ptr<Extension>>& extensions) {
-    auto is_read_eligible = [](char c) -> bool { (void) c; return true; };
-    return count_bases(extensions, is_read_eligible, 0);
+BasesCounter count_bases(const ExtensionSet& extensions, char base,
+                         int offset) {
+    return count_bases_if(extensions, BaseEquals(base), offset);
 }
 
 
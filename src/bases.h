@@ -13,18 +13,17 @@
 #define BASES_H
 
 #include <string>
-#include <memory>
 #include <vector>
 #include <utility>
 #include <functional>
 
 #include "extension.h"
+#include "base_tables.h"
 
 
 using std::string;
 using std::vector;
 using std::pair;
-using std::shared_ptr;
 
 
 /**
@@ -44,19 +43,68 @@ typedef std::function<bool(char)> bool_predicate;
  */
 namespace bases {
 
+
+/**
+ * @brief Modes of the majority vote.
+ */
+enum VoteMode {
+    /**
+     * @brief every base has one vote
+     */
+    UNWEIGHTED_VOTE,
+
+    /**
+     * @brief every base votes with its Phred quality plus one
+     */
+    QUALITY_WEIGHTED_VOTE
+};
+
+
+/**
+ * @brief Sets the mode of the majority vote.
+ *
+ * @param mode the desired vote mode
+ */
+void set_vote_mode(VoteMode mode);
+
+
+/**
+ * @brief Getter for the mode of the majority vote.
+ *
+ * @return Current vote mode, UNWEIGHTED_VOTE by default.
+ */
+VoteMode get_vote_mode();
+
+
+/**
+ * @brief Returns the vote weight of a base with the given Phred quality.
+ */
+inline uint32_t quality_weight(uint8_t quality) {
+    return quality + 1;
+}
+
+
 /**
  * @brief Used for calculating various statistics at specific positions in the
  * contig extension process.
  * @details The BasesCounter class is used for storing the frequency of
- * appearances of each base at a specific position. The class also calculates
- * the coverage and the most frequent base at the given position.
+ * appearances of each base at a specific position and the vote score of each
+ * base. The class also calculates the coverage and the base with the highest
+ * score at the given position.
  */
 class BasesCounter {
  public:
     /**
-     * @brief array used to store the number of appearances of each base
+     * @brief array used to store the number of appearances of each base, the
+     * last entry counts N and ambiguous bases which are never voted for
+     */
+    uint32_t count[NUM_BASE_CODES];
+
+    /**
+     * @brief vote score of each base, equal to count in the unweighted vote
+     * and to the sum of the base weights in the quality weighted vote
      */
-    uint32_t count[NUM_BASES];
+    uint32_t score[NUM_BASE_CODES];
 
     /**
      * @brief number of bases at this position, sum(count)
@@ -64,7 +112,7 @@ class BasesCounter {
     uint32_t coverage;
 
     /**
-     * @brief index in the count array of base with most appearances
+     * @brief index in the count array of base with the highest score
      */
     uint32_t max_idx;
 
@@ -76,21 +124,131 @@ class BasesCounter {
     /**
      * @brief Proccesing a single base
      * @details Converts the given base to it's corresponding index in the count
-     * array and increments the count at that index by one.
+     * array and increments the count at that index by one. N and ambiguous
+     * bases are counted at index BASE_N_IDX.
      *
      * @param base character base in a DNA sequence
      */
     void digest_base(char base);
 
+    /**
+     * @brief Proccesing a single weighted base
+     * @details Increments the count of the given base by one and its score by
+     * the given weight.
+     *
+     * @param base character base in a DNA sequence
+     * @param weight vote weight of the base
+     */
+    void digest_base(char base, uint32_t weight);
+
     /**
      * @brief Refresh all member variables
-     * @details The count array is used to compute the coverage and the most
-     * frequent base.
+     * @details The count array is used to compute the coverage and the score
+     * array to compute the elected base.
      */
     void refresh_stats();
 };
 
 
+/**
+ * @brief Predicate accepting every read.
+ */
+struct AllReads {
+    /**
+     * @brief Always returns true.
+     */
+    bool operator()(char base) const {
+        (void) base;
+        return true;
+    }
+};
+
+
+/**
+ * @brief Predicate accepting reads whose current base equals a given base.
+ */
+struct BaseEquals {
+    /**
+     * @brief the base an eligible read must have at its current position
+     */
+    char base;
+
+    /**
+     * @brief BaseEquals constructor
+     *
+     * @param base base an eligible read must have at its current position
+     */
+    explicit BaseEquals(char base): base(base) {}
+
+    /**
+     * @brief Returns true if the given base equals the stored base.
+     */
+    bool operator()(char other) const {
+        return other == base;
+    }
+};
+
+
+/**
+ * @brief Count bases at a specific position in the given extensions.
+ * @details Template version of count_bases, the predicate is a template
+ * parameter so it is inlined into the loop instead of being called through
+ * std::function.
+ *
+ * @param extensions Extension sequences
+ * @param is_read_eligible predicate called over the active base of each
+ * extension, should return true if the base should be processed
+ * @param offset the offset from current index in all extensions of the
+ * base to be digested
+ *
+ * @return BasesCounter object with summarized data from one base from each
+ * extension
+ */
+template<typename Predicate>
+BasesCounter count_bases_if(const ExtensionSet& extensions,
+                            const Predicate& is_read_eligible,
+                            int offset) {
+    BasesCounter counter;
+
+    const char *arena = extensions.arena();
+    const uint32_t *offsets = extensions.offsets();
+    const uint32_t *lengths = extensions.lengths();
+    const uint32_t *cursors = extensions.cursors();
+    const uint64_t *dropped = extensions.dropped_bitmap();
+
+    const uint8_t *quals = extensions.quality_arena();
+    bool weighted = get_vote_mode() == QUALITY_WEIGHTED_VOTE;
+
+    uint32_t size = extensions.size();
+
+    for (uint32_t j = 0; j < size; ++j) {
+        if ((dropped[j >> 6] >> (j & 63)) & 1) {
+            continue;
+        }
+
+        uint32_t position = cursors[j];
+        const char *seq = arena + offsets[j];
+
+        if (position + offset < lengths[j] &&
+            is_read_eligible(seq[position])) {
+            uint32_t weight = weighted ?
+                quality_weight(quals[offsets[j] + position + offset]) : 1;
+            counter.digest_base(seq[position + offset], weight);
+        }
+    }
+
+    counter.refresh_stats();
+    return counter;
+}
+
+
+// instantiated once in bases.cpp
+extern template BasesCounter count_bases_if<AllReads>(
+    const ExtensionSet&, const AllReads&, int);
+extern template BasesCounter count_bases_if<BaseEquals>(
+    const ExtensionSet&, const BaseEquals&, int);
+
+
 /**
  * @brief Count bases at a specific position in the given extensions.
  * @details Creates a BasesCounter object and digests one base from each
@@ -100,13 +258,13 @@ class BasesCounter {
  * first unprocessed index in it's sequence
  * @param is_read_eligible lambda function called over the active base of each
  * extension, should return true if the base should be processed
- * @param offset the offset from current index in all Extension objects of the
+ * @param offset the offset from current index in all extensions of the
  * base to be digested
  *
  * @return BasesCounter object with summarized data from one base from each
  * extension
  */
-BasesCounter count_bases(const vector<shared_ptr<Extension>>& extensions,
+BasesCounter count_bases(const ExtensionSet& extensions,
                          bool_predicate is_read_eligible,
                          int offset);
 
@@ -122,7 +280,22 @@ BasesCounter count_bases(const vector<shared_ptr<Extension>>& extensions,
  * @return BasesCounter object with summarized data from one base from each
  * extension
  */
-BasesCounter count_bases(const vector<shared_ptr<Extension>>& extensions);
+BasesCounter count_bases(const ExtensionSet& extensions);
+
+
+/**
+ * @brief Count bases in extensions whose current base equals the given base.
+ * @details Wrapper method for count_bases_if with the BaseEquals predicate.
+ *
+ * @param extensions Extension sequences
+ * @param base base an eligible read must have at its current position
+ * @param offset the offset from current index of the base to be digested
+ *
+ * @return BasesCounter object with summarized data from one base from each
+ * eligible extension
+ */
+BasesCounter count_bases(const ExtensionSet& extensions, char base,
+                         int offset);
 
 
 }  // namespace bases
@@ -0,0 +1,254 @@
+/**
+ * @file bridge.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the read bridge functions.
+ * @details Implementation file for the read bridge functions.
+ */
+#include <algorithm>
+#include <vector>
+#include <string>
+
+#include "bridge.h"
+#include "bases.h"
+
+
+using seqan::BamAlignmentRecord;
+using seqan::length;
+
+
+namespace bridge {
+
+
+// alignment of a read in forward read coordinates
+struct ReadAlignment {
+    uint32_t read_idx;
+    uint32_t read_begin;
+    uint32_t read_end;
+    uint32_t contig_idx;
+    uint32_t contig_begin;
+    uint32_t contig_end;
+    bool reverse;
+};
+
+
+static bool create_read_alignment(const BamAlignmentRecord& record,
+                                  uint32_t contig_idx, uint32_t read_idx,
+                                  uint32_t read_len, ReadAlignment *paln) {
+    uint32_t clipped = 0, aligned = 0, contig_span = 0;
+    bool leading = true;
+
+    for (auto const& e : record.cigar) {
+        if (e.operation == 'S' || e.operation == 'H') {
+            if (leading) {
+                clipped += e.count;
+            }
+            continue;
+        }
+
+        leading = false;
+        if (utility::contributes_to_seq_len(e.operation)) {
+            aligned += e.count;
+        }
+        if (utility::contributes_to_contig_len(e.operation)) {
+            contig_span += e.count;
+        }
+    }
+
+    if (aligned == 0 || clipped + aligned > read_len) {
+        return false;
+    }
+
+    auto& aln = *paln;
+    aln.read_idx = read_idx;
+    aln.contig_idx = contig_idx;
+    aln.contig_begin = record.beginPos;
+    aln.contig_end = record.beginPos + contig_span;
+    aln.reverse = record.flag & COMPLEMENT;
+
+    // clipping is given on the strand the read is aligned with
+    if (aln.reverse) {
+        aln.read_begin = read_len - clipped - aligned;
+        aln.read_end = read_len - clipped;
+    } else {
+        aln.read_begin = clipped;
+        aln.read_end = clipped + aligned;
+    }
+
+    return true;
+}
+
+
+static void reverse_complement(string *pseq) {
+    auto& seq = *pseq;
+    std::reverse(seq.begin(), seq.end());
+
+    for (auto& base : seq) {
+        base = bases::complement(base);
+    }
+}
+
+
+void find_read_links(const AlignmentCollection& alignments,
+                     const vector<uint32_t>& contig_lens,
+                     const unordered_map<string, uint32_t>& read_name_to_id,
+                     const StringSet<Dna5String>& read_seqs,
+                     vector<ReadLink> *plinks) {
+    vector<ReadAlignment> read_alns;
+
+    for (auto const& contig_alns : alignments) {
+        for (auto const& record : contig_alns.second) {
+            if ((record.flag & UNMAPPED) ||
+                    (record.flag & SECONDARY_ALIGNMENT)) {
+                continue;
+            }
+
+            string read_name = utility::CharString_to_string(record.qName);
+            auto it = read_name_to_id.find(
+                read_name.substr(0, read_name.find(' ')));
+            if (it == read_name_to_id.end()) {
+                continue;
+            }
+
+            ReadAlignment aln;
+            if (create_read_alignment(record, contig_alns.first, it->second,
+                                      length(read_seqs[it->second]), &aln)) {
+                read_alns.emplace_back(aln);
+            }
+        }
+    }
+
+    std::sort(read_alns.begin(), read_alns.end(),
+              [](const ReadAlignment& a, const ReadAlignment& b) {
+        if (a.read_idx != b.read_idx) {
+            return a.read_idx < b.read_idx;
+        }
+        return a.read_begin < b.read_begin;
+    });
+
+    auto& links = *plinks;
+
+    for (uint32_t i = 0; i + 1 < read_alns.size(); ++i) {
+        const ReadAlignment& x = read_alns[i];
+        const ReadAlignment& y = read_alns[i + 1];
+
+        if (x.read_idx != y.read_idx || x.contig_idx == y.contig_idx) {
+            continue;
+        }
+
+        // contig bases between the alignments and the linked contig ends
+        int x_overhang = x.reverse ? x.contig_begin :
+                                     contig_lens[x.contig_idx] - x.contig_end;
+        int y_overhang = y.reverse ? contig_lens[y.contig_idx] - y.contig_end :
+                                     y.contig_begin;
+
+        if (x_overhang > BRIDGE_END_MARGIN || y_overhang > BRIDGE_END_MARGIN) {
+            continue;
+        }
+
+        int read_gap = static_cast<int>(y.read_begin) - x.read_end;
+        int gap = read_gap - x_overhang - y_overhang;
+        if (gap > BRIDGE_MAX_GAP) {
+            continue;
+        }
+
+        ReadLink link;
+        link.ends[0] = 2 * x.contig_idx + (x.reverse ? LEFT : RIGHT);
+        link.ends[1] = 2 * y.contig_idx + (y.reverse ? RIGHT : LEFT);
+        link.gap = gap;
+
+        if (gap > 0) {
+            const Dna5String& read = read_seqs[x.read_idx];
+            uint32_t begin = x.read_end + x_overhang;
+
+            link.bases.reserve(gap);
+            for (uint32_t j = begin; j < begin + gap; ++j) {
+                link.bases.push_back(static_cast<char>(read[j]));
+            }
+        }
+
+        if (link.ends[0] > link.ends[1]) {
+            std::swap(link.ends[0], link.ends[1]);
+            reverse_complement(&link.bases);
+        }
+
+        links.emplace_back(std::move(link));
+    }
+}
+
+
+vector<LinkEdge> build_link_graph(const vector<ReadLink>& links) {
+    vector<LinkEdge> edges;
+    unordered_map<uint64_t, uint32_t> edge_idx;
+
+    for (uint32_t i = 0; i < links.size(); ++i) {
+        uint64_t key = (static_cast<uint64_t>(links[i].ends[0]) << 32) |
+                       links[i].ends[1];
+
+        auto inserted = edge_idx.insert({key, edges.size()});
+        if (inserted.second) {
+            edges.push_back({{links[i].ends[0], links[i].ends[1]}, {}});
+        }
+
+        edges[inserted.first->second].links.push_back(i);
+    }
+
+    edges.erase(std::remove_if(edges.begin(), edges.end(),
+                               [](const LinkEdge& edge) {
+        return edge.links.size() < BRIDGE_MIN_SUPPORT;
+    }), edges.end());
+
+    std::sort(edges.begin(), edges.end(),
+              [](const LinkEdge& a, const LinkEdge& b) {
+        if (a.links.size() != b.links.size()) {
+            return a.links.size() > b.links.size();
+        }
+        if (a.ends[0] != b.ends[0]) {
+            return a.ends[0] < b.ends[0];
+        }
+        return a.ends[1] < b.ends[1];
+    });
+
+    return edges;
+}
+
+
+int link_gap(const LinkEdge& edge, const vector<ReadLink>& links) {
+    vector<int> gaps;
+    gaps.reserve(edge.links.size());
+
+    for (auto idx : edge.links) {
+        gaps.push_back(links[idx].gap);
+    }
+
+    auto median = gaps.begin() + gaps.size() / 2;
+    std::nth_element(gaps.begin(), median, gaps.end());
+    return *median;
+}
+
+
+string link_consensus(const LinkEdge& edge, const vector<ReadLink>& links,
+                      uint32_t from_end, NativePoa *ppoa) {
+    vector<string> sequences;
+
+    for (auto idx : edge.links) {
+        if (links[idx].bases.empty()) {
+            continue;
+        }
+
+        sequences.push_back(links[idx].bases);
+        if (from_end != edge.ends[0]) {
+            reverse_complement(&sequences.back());
+        }
+    }
+
+    if (sequences.size() < 2) {
+        return sequences.empty() ? string() : sequences[0];
+    }
+
+    return ppoa->consensus(sequences);
+}
+
+
+}  // namespace bridge
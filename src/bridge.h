@@ -0,0 +1,159 @@
+/**
+ * @file bridge.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the read bridge functions.
+ * @details Header file for the read bridge functions. Long reads whose
+ * primary and supplementary alignments reach the ends of two contigs bridge
+ * the gap between them, even if the contig extensions do not overlap. The
+ * links are harvested from the initial alignment of the reads to the draft
+ * genome and grouped into a graph of contig ends weighted by read support.
+ */
+#ifndef BRIDGE_H
+#define BRIDGE_H
+
+#include <seqan/sequence.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+#include "contig.h"
+#include "utility.h"
+#include "poa_kernel.h"
+
+
+using std::vector;
+using std::string;
+using std::unordered_map;
+using seqan::StringSet;
+using seqan::Dna5String;
+
+
+/**
+ * @brief Maximum number of contig bases in BP an alignment may leave
+ * uncovered at the bridged contig end
+ */
+#define BRIDGE_END_MARGIN 500
+
+/**
+ * @brief Maximum gap in BP between two bridged contig ends
+ */
+#define BRIDGE_MAX_GAP 10000
+
+/**
+ * @brief Minimum number of reads supporting a bridge
+ */
+#define BRIDGE_MIN_SUPPORT 3
+
+
+/**
+ * @brief Namespace for read bridge functions
+ */
+namespace bridge {
+
+
+/**
+ * @brief A read leaving one contig end and entering another.
+ * @details Contig ends are numbered 2 * contig_idx + side as in the overlap
+ * graph, sides refer to the draft orientation of the contigs.
+ */
+struct ReadLink {
+    /**
+     * @brief Linked contig ends, ends[0] < ends[1].
+     */
+    uint32_t ends[2];
+
+    /**
+     * @brief Estimated number of bases between the contig ends, negative if
+     * the contig ends overlap.
+     */
+    int gap;
+
+    /**
+     * @brief Read bases between the contig ends, oriented from ends[0] to
+     * ends[1], empty if the gap is not positive.
+     */
+    string bases;
+};
+
+
+/**
+ * @brief Edge of the read link graph.
+ */
+struct LinkEdge {
+    /**
+     * @brief Linked contig ends, ends[0] < ends[1].
+     */
+    uint32_t ends[2];
+
+    /**
+     * @brief Indices of the supporting read links.
+     */
+    vector<uint32_t> links;
+};
+
+
+/**
+ * @brief Harvests read links from the alignments to the draft genome.
+ * @details Primary and supplementary alignments of each read are ordered by
+ * their position in the read. Two consecutive alignments to different
+ * contigs link the contig ends the read leaves and enters if both alignments
+ * reach their contig end within BRIDGE_END_MARGIN bases. Secondary
+ * alignments are ignored, as are links with a gap over BRIDGE_MAX_GAP.
+ *
+ * @param alignments alignments of the reads, keyed by contig index
+ * @param contig_lens lengths of the draft contigs
+ * @param read_name_to_id mapping from read name to read index
+ * @param read_seqs read sequences
+ * @param plinks pointer to the output read links
+ */
+void find_read_links(const AlignmentCollection& alignments,
+                     const vector<uint32_t>& contig_lens,
+                     const unordered_map<string, uint32_t>& read_name_to_id,
+                     const StringSet<Dna5String>& read_seqs,
+                     vector<ReadLink> *plinks);
+
+
+/**
+ * @brief Groups read links into the edges of the link graph.
+ * @details Only edges with at least BRIDGE_MIN_SUPPORT links are returned.
+ * Edges are sorted by decreasing support, ties are broken by the contig end
+ * indices.
+ *
+ * @param links read links
+ * @return Edges of the link graph.
+ */
+vector<LinkEdge> build_link_graph(const vector<ReadLink>& links);
+
+
+/**
+ * @brief Estimates the gap bridged by an edge.
+ *
+ * @param edge edge of the link graph
+ * @param links read links
+ * @return Median gap of the supporting links.
+ */
+int link_gap(const LinkEdge& edge, const vector<ReadLink>& links);
+
+
+/**
+ * @brief Computes the gap sequence bridged by an edge.
+ * @details The bases of the supporting links are oriented from the given
+ * contig end and combined by the native POA consensus.
+ *
+ * @param edge edge of the link graph
+ * @param links read links
+ * @param from_end contig end the sequence starts at, one of edge.ends
+ * @param ppoa pointer to the POA kernel used for the consensus
+ * @return Gap sequence, empty if no link has gap bases.
+ */
+string link_consensus(const LinkEdge& edge, const vector<ReadLink>& links,
+                      uint32_t from_end, NativePoa *ppoa);
+
+
+}  // namespace bridge
+
+
+#endif  // BRIDGE_H
@@ -0,0 +1,89 @@
+/**
+ * @file collector.h
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the ResultCollector class template.
+ * @details Header file for the ResultCollector class template. The collector
+ * gathers the results of parallel tasks without any locking.
+ */
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+
+using std::vector;
+
+
+/**
+ * @brief Lock-free collector of task results.
+ * @details Every task owns exactly one slot of the collector, identified by
+ * the index of the task. Tasks write only to their own slot, so no
+ * synchronization is needed while they are running. Results are read once all
+ * tasks have finished, e.g. after ThreadPool::wait, in task order regardless
+ * of the order of completion.
+ *
+ * @tparam T type of a single result
+ */
+template<typename T>
+class ResultCollector {
+ public:
+    /**
+     * @brief ResultCollector class constructor.
+     *
+     * @param num_tasks number of tasks, i.e. slots
+     */
+    explicit ResultCollector(uint32_t num_tasks):
+        slots_(num_tasks), is_stored_(num_tasks, false) {}
+
+
+    /**
+     * @brief Stores the result of a task.
+     * @details Must be called at most once per slot.
+     *
+     * @param task_idx index of the task
+     * @param result result of the task
+     */
+    void store(uint32_t task_idx, T&& result) {
+        slots_[task_idx] = std::move(result);
+        is_stored_[task_idx] = true;
+    }
+
+
+    /**
+     * @brief Checks if the task stored a result.
+     *
+     * @param task_idx index of the task
+     * @return True if a result was stored, false otherwise.
+     */
+    bool has_result(uint32_t task_idx) const {
+        return is_stored_[task_idx];
+    }
+
+
+    /**
+     * @brief Getter for the result of a task.
+     *
+     * @param task_idx index of the task
+     * @return Result of the task.
+     */
+    T& result(uint32_t task_idx) { return slots_[task_idx]; }
+
+
+    /**
+     * @brief Getter for the number of slots.
+     * @return Number of slots.
+     */
+    uint32_t size() const { return slots_.size(); }
+
+ private:
+    // one result per task
+    vector<T> slots_;
+    // one flag per task, char instead of bool to avoid a shared bit vector
+    vector<char> is_stored_;
+};
+
+
+#endif  // COLLECTOR_H
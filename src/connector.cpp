@@ -13,10 +13,17 @@
 #include <algorithm>
 #include <string>
 #include <stdexcept>
+#include <iostream>
+#include <fstream>
 
 #include "aligners/aligner.h"
 #include "connector.h"
+#include "anchors.h"
+#include "end_index.h"
+#include "overlap.h"
 #include "utility.h"
+#include "thread_pool.h"
+#include "resources.h"
 
 
 using std::runtime_error;
@@ -32,16 +39,27 @@ using seqan::BamAlignmentRecord;
 using seqan::length;
 
 
-const char* Connector::tmp_reference_file = "tmp/connector_reference.fasta";
+const char* Connector::tmp_reference_file = "tmp/connector_reference_%u.fasta";
 const char* Connector::tmp_anchors_file = "tmp/connector_anchors.fasta";
-const char* Connector::tmp_alignment_file = "tmp/connector_alignment.sam";
+const char* Connector::tmp_alignment_file = "tmp/connector_alignment_%u.sam";
 
 
 Connector::Connector(const vector<Contig*>& contigs):
-                    contigs_(contigs) {
-    for (auto contig : contigs_) {
-        string id = utility::CharString_to_string(contig->id());
-        unused_contigs[id] = contig;
+                    contigs_(contigs),
+                    is_reversed_(contigs.size(), false),
+                    used_anchors_(2 * contigs.size(), false),
+                    is_placed_(contigs.size(), false),
+                    next_seed_(0),
+                    num_free_(contigs.size()),
+                    parent_(contigs.size()),
+                    set_size_(contigs.size(), 1),
+                    scaffold_slot_(contigs.size(), -1),
+                    curr(nullptr),
+                    read_links_(nullptr) {
+    for (uint32_t i = 0; i < contigs_.size(); ++i) {
+        string id = utility::CharString_to_string(contigs_[i]->id());
+        contig_idx_[id] = i;
+        parent_[i] = i;
     }
 }
 
@@ -52,167 +70,676 @@ Connector::~Connector() {
     for (auto scaffold : scaffolds) {
         delete scaffold;
     }
+
+    for (auto contig : gap_contigs_) {
+        delete contig;
+    }
 }
 
 
-void Connector::connect_contigs(bool trim_circular_genome) {
-    cout << "\tWriting contig anchors to file..." << endl;
-    Contig::dump_anchors(contigs_, tmp_anchors_file);
+void Connector::connect_contigs(bool trim_circular_genome,
+                                bool use_overlap_graph,
+                                bool use_end_index) {
+    AnchorSet anchors(contigs_);
+
+    if (use_end_index) {
+        evaluate_index_overlaps(anchors);
+    } else {
+        cout << "\tWriting contig anchors to file..." << endl;
+        anchors.write(tmp_anchors_file);
+
+        evaluate_overlaps();
+    }
 
-    curr = create_scaffold();
-    scaffolds.emplace_back(curr);
+    if (use_overlap_graph) {
+        build_graph_scaffolds();
+    } else {
+        curr = create_scaffold();
 
-    bool found = false;
-    while (curr != nullptr) {
-        found = connect_next();
-        if (!found) {
-            curr = create_scaffold();
-            if (curr != nullptr) {
-                scaffolds.emplace_back(curr);
+        bool found = false;
+        while (curr != nullptr) {
+            found = connect_next();
+            if (!found) {
+                curr = create_scaffold();
             }
         }
+
+        // drop the slots of merged scaffolds
+        scaffolds.erase(std::remove(scaffolds.begin(), scaffolds.end(),
+                                    nullptr), scaffolds.end());
+    }
+
+    if (read_links_ != nullptr && !read_links_->empty()) {
+        bridge_scaffolds();
     }
 
     if (trim_circular_genome) {
         cout << "\tCorrecting circular genome scaffolds..." << endl;
 
+        // every task writes only its own slot
+        vector<char> did_correct(scaffolds.size(), false);
+
+        {
+            ThreadLease lease(WORKER_THREADS, utility::get_concurrency_level());
+            ThreadPool pool(lease.threads());
+
+            for (uint32_t i = 0; i < scaffolds.size(); i++) {
+                pool.submit([this, i, &did_correct] (uint32_t) {
+                    did_correct[i] = correct_circular_scaffold(scaffolds[i]);
+                });
+            }
+
+            pool.wait();
+        }
+
         for (uint32_t i = 0; i < scaffolds.size(); i++) {
             cout << "\t\tExamining scaffold [" << i + 1 << "/"
                 << scaffolds.size() << "]... ";
+            cout << (did_correct[i] ? "CORRECTED" : "UNTOUCHED") << endl;
+        }
+    }
+}
+
+
+void Connector::evaluate_overlaps() {
+    for (int orientation = 0; orientation < 2; ++orientation) {
+        candidates_[orientation].clear();
+        candidates_[orientation].resize(contigs_.size());
+    }
+
+    ThreadLease lease(WORKER_THREADS, utility::get_concurrency_level());
+    ThreadPool pool(lease.threads());
 
-            bool did_correct = correct_circular_scaffold(scaffolds[i]);
+    cout << "\tEvaluating overlaps of " << 2 * contigs_.size()
+        << " contig ends using " << pool.size() << " workers..." << endl;
 
-            cout << (did_correct ? "CORRECTED" : "UNTOUCHED") << endl;
+    for (uint32_t i = 0; i < contigs_.size(); ++i) {
+        for (int orientation = 0; orientation < 2; ++orientation) {
+            pool.submit([this, i, orientation] (uint32_t worker_id) {
+                candidates_[orientation][i] = find_overlap_candidates(
+                    contigs_[i], orientation == 1, worker_id);
+            });
         }
     }
+
+    pool.wait();
 }
 
 
-bool Connector::connect_next() {
-    Contig *curr_contig = curr->last_contig();
-    string curr_contig_id = utility::CharString_to_string(curr_contig->id());
+vector<OverlapCandidate> Connector::find_overlap_candidates(
+        Contig *contig, bool reverse, uint32_t worker_id) {
+    string reference_file = utility::create_seq_id(tmp_reference_file,
+                                                   worker_id);
+    string alignment_file = utility::create_seq_id(tmp_alignment_file,
+                                                   worker_id);
 
-    DEBUG("Current contig: " << curr_contig->id() << endl)
+    // the right extension of the reversed contig is the left one
+    int right_ext_pos = contig->total_len() - (reverse ?
+        contig->total_ext_left() : contig->total_ext_right());
+
+    // the whole contig read backwards is its reverse complement
+    SequenceSlice contig_seq = contig->slice(0, contig->total_len());
+    contig_seq.reverse = contig_seq.reverse != reverse;
 
-    utility::write_fasta(curr_contig->id(), curr_contig->seq(),
-                         tmp_reference_file);
+    utility::write_fasta(utility::CharString_to_string(contig->id()),
+                         {contig_seq}, reference_file.c_str());
 
-    Aligner::get_instance().index(tmp_reference_file);
-    Aligner::get_instance().align(tmp_reference_file, tmp_anchors_file,
-                                  tmp_alignment_file, true);
+    Aligner::get_instance().index(reference_file.c_str());
+    Aligner::get_instance().align(reference_file.c_str(), tmp_anchors_file,
+                                  alignment_file.c_str(), true);
 
     BamHeader header;
     vector<BamAlignmentRecord> records;
-    utility::read_sam(&header, &records, tmp_alignment_file);
+    utility::read_sam(&header, &records, alignment_file.c_str());
 
-    for (auto const& record : records) {
-        DEBUG("Examining record for anchor: " << record.qName)
+    vector<OverlapCandidate> candidates;
 
+    for (auto const& record : records) {
         if ((record.flag & UNMAPPED) || (record.flag & SECONDARY_LINE)) {
             continue;
         }
 
-        if (used_ids_.count(utility::CharString_to_string(record.qName)) > 0) {
+        OverlapCandidate candidate;
+        candidate.anchor_id = utility::CharString_to_string(record.qName);
+        candidate.next_id = candidate.anchor_id.substr(
+            0, candidate.anchor_id.length() - 1);
+        candidate.anchor_side = candidate.anchor_id.back() == 'L' ? LEFT :
+                                                                    RIGHT;
+
+        auto it = contig_idx_.find(candidate.next_id);
+        if (it == contig_idx_.end()) {
+            utility::throw_exception<runtime_error>("Contig invalid id");
+        }
+        candidate.next_idx = it->second;
+        candidate.begin_pos = record.beginPos;
+        candidate.is_complement = record.flag & COMPLEMENT;
+        candidate.connect = should_connect(contig, record);
+        candidate.merge_start = max(right_ext_pos, record.beginPos);
+
+        candidate.overlap_len = 0;
+        for (auto const& e : record.cigar) {
+            if (utility::contributes_to_contig_len(e.operation) &&
+                e.operation != 'S') {
+                candidate.overlap_len += e.count;
+            }
+        }
+
+        candidates.emplace_back(candidate);
+    }
+
+    return candidates;
+}
+
+
+void Connector::evaluate_index_overlaps(const AnchorSet& anchors) {
+    for (int orientation = 0; orientation < 2; ++orientation) {
+        candidates_[orientation].clear();
+        candidates_[orientation].resize(contigs_.size());
+    }
+
+    EndIndex index(anchors);
+
+    cout << "\tIndexed " << index.size() << " minimizers of "
+        << anchors.size() << " contig ends" << endl;
+
+    ThreadLease lease(WORKER_THREADS, utility::get_concurrency_level());
+    ThreadPool pool(lease.threads());
+
+    cout << "\tEvaluating overlaps of " << 2 * contigs_.size()
+        << " contig ends using " << pool.size() << " workers..." << endl;
+
+    for (uint32_t first = 0; first < contigs_.size();
+            first += END_INDEX_BATCH_SIZE) {
+        uint32_t last = min<uint32_t>(first + END_INDEX_BATCH_SIZE,
+                                      contigs_.size());
+
+        pool.submit([this, first, last, &index, &anchors] (uint32_t) {
+            // right end of both orientations of every contig in the batch
+            vector<SequenceSlice> ends;
+            for (uint32_t i = first; i < last; ++i) {
+                for (int orientation = 0; orientation < 2; ++orientation) {
+                    SequenceSlice end = contigs_[i]->anchor_slice(
+                        orientation == 0 ? RIGHT : LEFT);
+                    end.reverse = end.reverse != (orientation == 1);
+                    ends.push_back(end);
+                }
+            }
+
+            vector<vector<EndHit>> hits;
+            index.query(ends, &hits);
+
+            for (uint32_t i = first, k = 0; i < last; ++i) {
+                for (int orientation = 0; orientation < 2; ++orientation, ++k) {
+                    uint32_t end_begin = contigs_[i]->total_len() -
+                                         (ends[k].end - ends[k].begin);
+                    candidates_[orientation][i] = find_index_candidates(
+                        i, orientation == 1, end_begin, hits[k], anchors);
+                }
+            }
+        });
+    }
+
+    pool.wait();
+}
+
+
+vector<OverlapCandidate> Connector::find_index_candidates(
+        uint32_t idx, bool reverse, uint32_t end_begin,
+        const vector<EndHit>& hits, const AnchorSet& anchors) {
+    Contig *contig = contigs_[idx];
+    int contig_len = contig->total_len();
+
+    // the right extension of the reversed contig is the left one
+    int right_ext_pos = contig_len - (reverse ? contig->total_ext_left() :
+                                                contig->total_ext_right());
+
+    // the whole contig read backwards is its reverse complement
+    SequenceSlice contig_seq = contig->slice(0, contig_len);
+    contig_seq.reverse = contig_seq.reverse != reverse;
+
+    vector<OverlapCandidate> candidates;
+
+    for (auto const& hit : hits) {
+        const AnchorView& anchor = anchors[hit.anchor_idx];
+
+        // the anchors of the contig itself are never joined to it
+        if (anchor.contig_idx == idx) {
+            continue;
+        }
+
+        SequenceSlice anchor_seq = anchor.slice;
+        anchor_seq.reverse = anchor_seq.reverse != hit.is_complement;
+
+        int64_t begin_pos = max<int64_t>(end_begin + hit.offset, 0);
+        if (begin_pos >= contig_len) {
             continue;
         }
 
-        string anchor_id = utility::CharString_to_string(record.qName);
-        string next_id = anchor_id.substr(0, anchor_id.length() - 1);
+        overlap::EndOverlap end_overlap;
+        if (!overlap::verify_end_overlap(anchor_seq, contig_seq, begin_pos,
+                                         &end_overlap)) {
+            continue;
+        }
+
+        OverlapCandidate candidate;
+        candidate.anchor_id = utility::CharString_to_string(*anchor.id);
+        candidate.next_id = utility::CharString_to_string(
+            contigs_[anchor.contig_idx]->id());
+        candidate.next_idx = anchor.contig_idx;
+        candidate.anchor_side = anchor.side;
+        candidate.begin_pos = begin_pos;
+        candidate.is_complement = hit.is_complement;
+        candidate.connect = should_connect(anchor.length(), end_overlap);
+        candidate.merge_start = max(right_ext_pos, candidate.begin_pos);
+        candidate.overlap_len = contig_len - candidate.begin_pos;
+
+        candidates.emplace_back(candidate);
+    }
+
+    return candidates;
+}
+
+
+bool Connector::connect_next() {
+    Contig *curr_contig = curr->last_contig();
+    string curr_contig_id = utility::CharString_to_string(curr_contig->id());
+
+    DEBUG("Current contig: " << curr_contig->id() << endl)
+
+    uint32_t curr_idx = contig_idx_[curr_contig_id];
+    auto const& candidates = candidates_[is_reversed_[curr_idx]][curr_idx];
+
+    for (auto const& candidate : candidates) {
+        DEBUG("Examining record for anchor: " << candidate.anchor_id)
+
+        uint32_t next_idx = candidate.next_idx;
+        uint32_t anchor_end = 2 * next_idx + candidate.anchor_side;
+
+        if (used_anchors_[anchor_end]) {
+            continue;
+        }
 
         // if next contig is the same as current
         // do not extend with itself
-        if (next_id == curr_contig_id) {
-            DEBUG("Id's are same [nxt, cur]: " << next_id << curr_contig_id)
+        if (next_idx == curr_idx) {
+            DEBUG("Id's are same [nxt, cur]: " << candidate.next_id
+                  << curr_contig_id)
             continue;
         }
 
         // if next contig is already in current scaffold
-        if (curr->contains(next_id)) {
+        if (find_root(next_idx) == find_root(curr_idx)) {
             break;
         }
 
         // if contig inside other scaffold
-        bool merge_scaffold = false;
-        bool is_first = false;
-        if (contig_to_scaffold.find(next_id) != contig_to_scaffold.end()) {
-            Scaffold *next_scaffold = contig_to_scaffold[next_id];
+        int next_slot = -1;
+        if (is_placed_[next_idx]) {
+            next_slot = scaffold_slot_[find_root(next_idx)];
+            Scaffold *next_scaffold = scaffolds[next_slot];
 
-            is_first = *(next_scaffold->first_contig()) != *(curr_contig);
+            bool is_first = next_scaffold->first_contig() != curr_contig;
 
             if (!is_first) {
                 continue;
             }
-
-            merge_scaffold = true;
         }
 
         // ovo je mozda problematicno - provjeriti!
-        if (!should_connect(curr_contig, record)) {
+        if (!candidate.connect) {
             continue;
         }
 
-        DEBUG("Attempting merge for anchor: " << record.qName)
+        DEBUG("Attempting merge for anchor: " << candidate.anchor_id)
 
-        Contig *next = find_contig(next_id);
+        Contig *next = contigs_[next_idx];
 
         cout << "\t\tConnecting contig: " << next->id() << endl;
 
-        int merge_start = max(curr_contig->right_ext_pos(), record.beginPos);
-        bool reverse_complement = record.flag & COMPLEMENT;
+        if (candidate.is_complement) {
+            next->reverse_complement();
+            is_reversed_[next_idx] = !is_reversed_[next_idx];
+        }
 
-        if (next == nullptr) {
-            utility::throw_exception<runtime_error>("Contig invalid id");
+        int last_end, this_start;
+        compute_join(curr_contig->total_len(), next->total_ext_left(),
+                     candidate, &last_end, &this_start);
+
+        curr->add_contig(next, last_end, this_start);
+
+        used_anchors_[anchor_end] = true;
+        used_anchors_[2 * curr_idx + (is_reversed_[curr_idx] ? LEFT : RIGHT)]
+            = true;
+
+        int curr_slot = scaffold_slot_[find_root(curr_idx)];
+
+        if (next_slot != -1) {
+            Scaffold *next_scaffold = scaffolds[next_slot];
+            curr->merge(next_scaffold);
+
+            // leave a tombstone in the slot of the merged scaffold
+            scaffolds[next_slot] = nullptr;
+            delete next_scaffold;
+        } else {
+            is_placed_[next_idx] = true;
+            --num_free_;
         }
 
-        if (reverse_complement) {
-            next->reverse_complement();
+        scaffold_slot_[unite(curr_idx, next_idx)] = curr_slot;
+        return true;
+    }
+
+    return false;
+}
+
+
+void Connector::compute_join(int curr_len, int next_ext_left,
+                             const OverlapCandidate& candidate,
+                             int *plast_end, int *pthis_start) {
+    int merge_start = candidate.merge_start;
+
+    int right_ext_len = curr_len - merge_start;
+    int next_start = min(right_ext_len, next_ext_left);
+    int merge_end = next_start + candidate.begin_pos;
+
+    int merge_len = merge_end - merge_start;
+
+    *plast_end = merge_start + merge_len / 2;
+    *pthis_start = next_start - merge_len / 2;
+}
+
+
+vector<OverlapEdge> Connector::build_overlap_graph() const {
+    vector<OverlapEdge> edges;
+    unordered_map<uint64_t, uint32_t> edge_idx;
+
+    for (uint32_t i = 0; i < contigs_.size(); ++i) {
+        for (int orientation = 0; orientation < 2; ++orientation) {
+            // the right end of the reversed contig is its left end
+            uint32_t end = 2 * i + (orientation == 0 ? RIGHT : LEFT);
+
+            for (auto const& candidate : candidates_[orientation][i]) {
+                if (!candidate.connect) {
+                    continue;
+                }
+
+                if (candidate.next_idx == i) {
+                    continue;
+                }
+
+                // the anchor must face the contig end it is aligned to
+                if ((candidate.anchor_side == LEFT) ==
+                        candidate.is_complement) {
+                    continue;
+                }
+
+                uint32_t other = 2 * candidate.next_idx +
+                                 candidate.anchor_side;
+                uint32_t first = min(end, other);
+                uint32_t second = max(end, other);
+                uint64_t key = (static_cast<uint64_t>(first) << 32) | second;
+
+                auto inserted = edge_idx.insert({key, edges.size()});
+                if (inserted.second) {
+                    edges.push_back({{first, second}, 0, {nullptr, nullptr}});
+                }
+
+                auto& edge = edges[inserted.first->second];
+                auto& observation = edge.observations[end == first ? 0 : 1];
+                if (observation == nullptr ||
+                        candidate.overlap_len > observation->overlap_len) {
+                    observation = &candidate;
+                }
+            }
         }
+    }
 
-        int right_ext_len = curr_contig->total_len() - merge_start;
-        int next_start = min(right_ext_len, next->total_ext_left());
-        int merge_end = next_start + record.beginPos;
+    for (auto& edge : edges) {
+        edge.weight = 0;
+        for (int k = 0; k < 2; ++k) {
+            if (edge.observations[k] != nullptr) {
+                edge.weight += edge.observations[k]->overlap_len;
+            }
+        }
+    }
 
-        int merge_len = merge_end - merge_start;
+    std::sort(edges.begin(), edges.end(),
+              [](const OverlapEdge& a, const OverlapEdge& b) {
+        if (a.weight != b.weight) {
+            return a.weight > b.weight;
+        }
+        if (a.ends[0] != b.ends[0]) {
+            return a.ends[0] < b.ends[0];
+        }
+        return a.ends[1] < b.ends[1];
+    });
 
-        curr->add_contig(next, merge_start + merge_len / 2,
-                         next_start - merge_len / 2);
+    return edges;
+}
 
-        Scaffold *next_scaffold = contig_to_scaffold[next_id];
-        contig_to_scaffold[next_id] = curr;
 
-        used_ids_.insert(anchor_id);
-        used_ids_.insert(utility::CharString_to_string(
-            curr_contig->right_id()));
+void Connector::build_graph_scaffolds() {
+    vector<OverlapEdge> edges = build_overlap_graph();
+    uint32_t num_ends = 2 * contigs_.size();
 
-        if (merge_scaffold) {
-            // Scaffold *next_scaffold = contig_to_scaffold[next_id];
-            curr->merge(next_scaffold);
+    cout << "\tBuilt overlap graph with " << edges.size() << " edges" << endl;
+
+    // accepted edge of each contig end, -1 if the end is free
+    vector<int> matched(num_ends, -1);
+    // the other end of the path ending at each free end
+    vector<uint32_t> path_end(num_ends);
+    for (uint32_t end = 0; end < num_ends; ++end) {
+        path_end[end] = end ^ 1;
+    }
+
+    uint32_t num_joins = 0;
+    for (uint32_t k = 0; k < edges.size(); ++k) {
+        uint32_t a = edges[k].ends[0];
+        uint32_t b = edges[k].ends[1];
+
+        // skip used ends and edges closing a cycle
+        if (matched[a] != -1 || matched[b] != -1 || path_end[a] == b) {
+            continue;
+        }
+
+        matched[a] = matched[b] = k;
+        uint32_t p = path_end[a];
+        uint32_t q = path_end[b];
+        path_end[p] = q;
+        path_end[q] = p;
+        ++num_joins;
+    }
+
+    cout << "\t\tAccepted " << num_joins << " joins" << endl;
 
-            // refresh contig to scaffold mapping
-            for (auto contig : next_scaffold->get_contigs()) {
-                string tmp_id = utility::CharString_to_string(contig->id());
-                contig_to_scaffold[tmp_id] = curr;
+    vector<bool> visited(contigs_.size(), false);
+    for (uint32_t i = 0; i < contigs_.size(); ++i) {
+        if (visited[i]) {
+            continue;
+        }
+
+        // start from a free end, entering the contig through it
+        uint32_t entry;
+        if (matched[2 * i + LEFT] == -1) {
+            entry = 2 * i + LEFT;
+        } else if (matched[2 * i + RIGHT] == -1) {
+            entry = 2 * i + RIGHT;
+        } else {
+            continue;
+        }
+
+        if (matched[entry ^ 1] == -1 &&
+                contigs_[i]->total_len() < MINIMUM_CONTIG_LEN) {
+            visited[i] = true;
+            continue;
+        }
+
+        Scaffold *scaffold = nullptr;
+        Contig *prev = nullptr;
+        int edge = -1;
+
+        while (true) {
+            uint32_t idx = entry / 2;
+            Contig *contig = contigs_[idx];
+            visited[idx] = true;
+
+            // the contig is reversed when entered through its right end
+            bool reverse = (entry & 1) == RIGHT;
+            if (reverse != is_reversed_[idx]) {
+                contig->reverse_complement();
+                is_reversed_[idx] = reverse;
             }
 
-            // remove scaffold from list
-            for (size_t i = 0; i < scaffolds.size(); ++i) {
-                if (scaffolds[i] == next_scaffold) {
-                    scaffolds.erase(scaffolds.begin() + i);
-                    break;
+            if (scaffold == nullptr) {
+                scaffold = new Scaffold(contig);
+                cout << "\tCreated scaffold with base contig: "
+                    << contig->id() << endl;
+            } else {
+                const OverlapEdge& join = edges[edge];
+                uint32_t prev_end = entry == join.ends[0] ? 1 : 0;
+
+                int last_end, this_start;
+                if (join.observations[prev_end] != nullptr) {
+                    compute_join(prev->total_len(), contig->total_ext_left(),
+                                 *join.observations[prev_end], &last_end,
+                                 &this_start);
+                } else {
+                    // mirror the join of the reverse complemented contigs
+                    int rev_last_end, rev_this_start;
+                    compute_join(contig->total_len(),
+                                 prev->total_ext_right(),
+                                 *join.observations[1 - prev_end],
+                                 &rev_last_end, &rev_this_start);
+                    last_end = prev->total_len() - rev_this_start;
+                    this_start = contig->total_len() - rev_last_end;
                 }
+
+                cout << "\t\tConnecting contig: " << contig->id() << endl;
+                scaffold->add_contig(contig, last_end, this_start);
             }
 
-            delete next_scaffold;
+            uint32_t exit = entry ^ 1;
+            edge = matched[exit];
+            if (edge == -1) {
+                break;
+            }
+
+            prev = contig;
+            const OverlapEdge& next = edges[edge];
+            entry = next.ends[0] == exit ? next.ends[1] : next.ends[0];
         }
 
-        if (!merge_scaffold) {
-            unused_contigs.erase(next_id);
+        scaffolds.emplace_back(scaffold);
+    }
+}
+
+
+uint32_t Connector::scaffold_end(Scaffold *scaffold, ContigSide side) {
+    Contig *contig = side == LEFT ? scaffold->first_contig() :
+                                    scaffold->last_contig();
+    uint32_t idx = contig_idx_[utility::CharString_to_string(contig->id())];
+
+    // the left end of the reversed contig is its right end
+    bool is_right = (side == RIGHT) != is_reversed_[idx];
+    return 2 * idx + (is_right ? RIGHT : LEFT);
+}
+
+
+void Connector::reverse_scaffold(Scaffold *scaffold) {
+    scaffold->reverse_complement();
+
+    for (auto contig : scaffold->get_contigs()) {
+        auto it = contig_idx_.find(utility::CharString_to_string(contig->id()));
+
+        // gap contigs have no index
+        if (it != contig_idx_.end()) {
+            is_reversed_[it->second] = !is_reversed_[it->second];
         }
+    }
+}
 
-        return true;
+
+void Connector::bridge_scaffolds() {
+    vector<bridge::LinkEdge> edges = bridge::build_link_graph(*read_links_);
+
+    cout << "\tBuilt read link graph with " << edges.size() << " edges"
+        << endl;
+
+    // scaffold slot of every contig end at a scaffold end, -1 otherwise
+    vector<int> end_slot(2 * contigs_.size(), -1);
+    for (uint32_t i = 0; i < scaffolds.size(); ++i) {
+        end_slot[scaffold_end(scaffolds[i], LEFT)] = i;
+        end_slot[scaffold_end(scaffolds[i], RIGHT)] = i;
     }
 
-    return false;
+    NativePoa poa;
+    uint32_t num_bridges = 0;
+
+    for (auto const& edge : edges) {
+        uint32_t a = edge.ends[0];
+        uint32_t b = edge.ends[1];
+
+        int left_slot = end_slot[a];
+        int right_slot = end_slot[b];
+        if (left_slot == -1 || right_slot == -1 || left_slot == right_slot) {
+            continue;
+        }
+
+        Scaffold *left = scaffolds[left_slot];
+        Scaffold *right = scaffolds[right_slot];
+
+        // the bridged ends have to face each other
+        if (scaffold_end(left, RIGHT) != a) {
+            reverse_scaffold(left);
+        }
+        if (scaffold_end(right, LEFT) != b) {
+            reverse_scaffold(right);
+        }
+
+        Contig *last = left->last_contig();
+        Contig *next = right->first_contig();
+
+        cout << "\t\tBridging contigs: " << last->id() << " "
+            << next->id() << " with " << edge.links.size() << " reads"
+            << endl;
+
+        // the extensions at the joint are replaced by the bridge
+        int last_end = last->right_ext_pos();
+        int this_start = next->total_ext_left();
+
+        int gap = bridge::link_gap(edge, *read_links_);
+        string gap_seq;
+        if (gap > 0) {
+            gap_seq = bridge::link_consensus(edge, *read_links_, a, &poa);
+        } else {
+            // the draft contigs overlap, skip the overlap in the next one
+            this_start = min(this_start - gap, next->right_ext_pos());
+        }
+
+        if (!gap_seq.empty()) {
+            Dna5String seq = gap_seq;
+            Contig *gap_contig = new Contig(seq, 0, 0);
+            gap_contigs_.emplace_back(gap_contig);
+
+            left->add_contig(gap_contig, last_end, 0);
+            last_end = gap_contig->total_len();
+        }
+
+        left->append(right, last_end, this_start);
+
+        end_slot[a] = end_slot[b] = -1;
+        end_slot[scaffold_end(left, RIGHT)] = left_slot;
+
+        // leave a tombstone in the slot of the appended scaffold
+        scaffolds[right_slot] = nullptr;
+        delete right;
+        ++num_bridges;
+    }
+
+    scaffolds.erase(std::remove(scaffolds.begin(), scaffolds.end(), nullptr),
+                    scaffolds.end());
+
+    cout << "\tBridged " << num_bridges << " scaffold gaps" << endl;
 }
 
 
@@ -248,99 +775,120 @@ bool Connector::should_connect(Contig *contig,
 }
 
 
-Contig* Connector::find_contig(const string& id) {
-    CharString contig_id = id;
+bool Connector::should_connect(uint32_t anchor_len,
+                               const overlap::EndOverlap& end_overlap) {
+    // anchor bases right of the contig end
+    int len = anchor_len - end_overlap.query_end;
+
+    return len > ANCHOR_THRESHOLD * ANCHOR_LEN;
+}
+
+
+Scaffold* Connector::create_scaffold() {
+    while (next_seed_ < contigs_.size()) {
+        uint32_t idx = next_seed_++;
 
-    for (auto contig : contigs_) {
-        if (contig->id() == contig_id) {
-            return contig;
+        // short contigs can only be connected into other scaffolds
+        if (is_placed_[idx] ||
+                contigs_[idx]->total_len() < MINIMUM_CONTIG_LEN) {
+            continue;
         }
+
+        Scaffold *scaffold = new Scaffold(contigs_[idx]);
+
+        cout << "\tCreated scaffold with base contig: "
+            << contigs_[idx]->id() << endl;
+
+        is_placed_[idx] = true;
+        --num_free_;
+
+        scaffold_slot_[find_root(idx)] = scaffolds.size();
+        scaffolds.emplace_back(scaffold);
+
+        cout << "\t\tRemaining free contigs: " << num_free_ << endl;
+
+        return scaffold;
     }
 
     return nullptr;
 }
 
 
-Scaffold* Connector::create_scaffold() {
-    if (unused_contigs.empty()) {
-        return nullptr;
+uint32_t Connector::find_root(uint32_t idx) {
+    while (parent_[idx] != idx) {
+        // path halving
+        parent_[idx] = parent_[parent_[idx]];
+        idx = parent_[idx];
     }
 
-    auto it = unused_contigs.begin();
-    Scaffold *scaffold = new Scaffold(it->second);
-
-    cout << "\tCreated scaffold with base contig: " << it->second->id() << endl;
+    return idx;
+}
 
-    contig_to_scaffold[it->first] = scaffold;
 
-    unused_contigs.erase(it);
+uint32_t Connector::unite(uint32_t a, uint32_t b) {
+    a = find_root(a);
+    b = find_root(b);
 
-    cout << "\t\tRemaining free contigs: " << unused_contigs.size() << endl;
+    if (a == b) {
+        return a;
+    }
 
-    if (scaffold->first_contig()->total_len() < MINIMUM_CONTIG_LEN) {
-        return create_scaffold();
+    if (set_size_[a] < set_size_[b]) {
+        std::swap(a, b);
     }
 
-    return scaffold;
+    parent_[b] = a;
+    set_size_[a] += set_size_[b];
+    return a;
 }
 
 
 void Connector::dump_scaffolds(const char *output_file) {
-    StringSet<Dna5String> scaffold_seqs;
-    StringSet<CharString> ids;
+    std::ofstream out(output_file);
+    if (!out) {
+        utility::exit_with_message("Could not open file %s", output_file);
+    }
 
+    // scaffolds are streamed from the contig sequences one by one
     for (uint32_t i = 0; i < scaffolds.size(); ++i) {
-        Dna5String sequence = scaffolds[i]->get_combined_sequence();
+        cout << "\tWriting scaffold " << i << " with length: "
+            << scaffolds[i]->length() << endl;
 
-        cout << "\tPreparing scaffold " << i << " with length: "
-            << length(sequence) << endl;
-
-        appendValue(ids, utility::create_seq_id("scaffold|%d", i));
-        appendValue(scaffold_seqs, sequence);
+        utility::write_fasta(out, utility::create_seq_id("scaffold|%d", i),
+                             scaffolds[i]->slices());
     }
 
-    utility::write_fasta(ids, scaffold_seqs, output_file);
+    if (!out) {
+        utility::exit_with_message("Could not write file %s", output_file);
+    }
 }
 
 
 bool Connector::correct_circular_scaffold(Scaffold *scaffold) {
-    Contig *last_contig = scaffold->last_contig();
-    string contig_id = utility::CharString_to_string(last_contig->id());
-
-    utility::write_fasta(last_contig->id(), last_contig->seq(),
-                         tmp_reference_file);
-
-    Aligner::get_instance().index(tmp_reference_file);
-    Aligner::get_instance().align(tmp_reference_file, tmp_anchors_file,
-                                  tmp_alignment_file, false);
-
     Contig *first_contig = scaffold->first_contig();
-    string left_id = utility::CharString_to_string(first_contig->left_id());
-
-    BamHeader header;
-    vector<BamAlignmentRecord> records;
-    utility::read_sam(&header, &records, tmp_alignment_file);
+    Contig *last_contig = scaffold->last_contig();
 
-    for (auto const& record : records) {
-        if ((record.flag & UNMAPPED) || (record.flag & SECONDARY_LINE)) {
-            continue;
-        }
+    SequenceSlice anchor = first_contig->anchor_slice(LEFT);
+    SequenceSlice contig = last_contig->slice(0, last_contig->total_len());
 
-        string anchor_id = utility::CharString_to_string(record.qName);
+    overlap::EndOverlap end_overlap;
+    if (!overlap::find_end_overlap(anchor, contig, &end_overlap)) {
+        return false;
+    }
 
-        if (anchor_id == left_id && should_connect(last_contig, record)) {
-            int trim_right_idx = max(last_contig->right_ext_pos(),
-                                     record.beginPos);
+    // if the anchor doesn't extend right of the contig skip it
+    if (!should_connect(anchor.end - anchor.begin, end_overlap)) {
+        return false;
+    }
 
-            int trim_left_idx = 0;
-            if (record.beginPos < last_contig->right_ext_pos()) {
-                trim_left_idx = last_contig->right_ext_pos() - record.beginPos;
-            }
+    int begin_pos = end_overlap.target_begin;
+    int trim_right_idx = max(last_contig->right_ext_pos(), begin_pos);
 
-            scaffold->trim(trim_left_idx, trim_right_idx);
-            return true;
-        }
+    int trim_left_idx = 0;
+    if (begin_pos < last_contig->right_ext_pos()) {
+        trim_left_idx = last_contig->right_ext_pos() - begin_pos;
     }
 
-    return false;
+    scaffold->trim(trim_left_idx, trim_right_idx);
+    return true;
 }
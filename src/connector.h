@@ -11,42 +11,110 @@
 
 #include <seqan/bam_io.h>
 #include <vector>
-#include <unordered_set>
 #include <unordered_map>
 #include <string>
 
 #include "contig.h"
+#include "utility.h"
 #include "scaffold.h"
+#include "anchors.h"
+#include "end_index.h"
+#include "overlap.h"
+#include "bridge.h"
 
 
 using std::vector;
 using std::string;
-using std::unordered_set;
 using std::unordered_map;
 using seqan::BamAlignmentRecord;
 
 
 /**
- * @brief SAM file flag denoting a non-primary alignment
+ * @brief Minimum percentage of anchor sequence that must extend the end of the
+ * current scaffold to extend it
  */
-#define SECONDARY_LINE 0x900
+#define ANCHOR_THRESHOLD 0.66
 
-/**
- * @brief SAM file flag denoting an unmapped query
- */
-#define UNMAPPED 0x4
 
 /**
- * @brief [brief description] SAM file flag denoting a query from the complement
- * strand of the reference genome
+ * @brief Alignment of an anchor to the right end of a contig.
+ * @details Candidates are computed for every contig and orientation before
+ * the scaffolds are built, the greedy walk only consumes them.
  */
-#define COMPLEMENT 0x10
+struct OverlapCandidate {
+    /**
+     * @brief ID of the aligned anchor.
+     */
+    string anchor_id;
+
+    /**
+     * @brief ID of the contig the anchor was created from.
+     */
+    string next_id;
+
+    /**
+     * @brief Index of the contig the anchor was created from.
+     */
+    uint32_t next_idx;
+
+    /**
+     * @brief Side of the contig the anchor was created from, in the
+     * original orientation of the contig.
+     */
+    ContigSide anchor_side;
+
+    /**
+     * @brief Start position of the anchor alignment in the contig.
+     */
+    int begin_pos;
+
+    /**
+     * @brief True if the anchor is aligned to the complement strand.
+     */
+    bool is_complement;
+
+    /**
+     * @brief Result of Connector::should_connect for the alignment.
+     */
+    bool connect;
+
+    /**
+     * @brief Position in the contig where the merge with the next contig
+     * starts.
+     */
+    int merge_start;
+
+    /**
+     * @brief Number of contig bases covered by the anchor alignment.
+     */
+    int overlap_len;
+};
+
 
 /**
- * @brief Minimum percentage of anchor sequence that must extend the end of the
- * current scaffold to extend it
+ * @brief Edge of the contig end overlap graph.
+ * @details Contig ends are numbered 2 * contig_idx + side, where the side
+ * refers to the contig in its original orientation. An edge joins two ends
+ * which overlap, i.e. the contigs can be placed next to each other with the
+ * joined ends facing each other.
  */
-#define ANCHOR_THRESHOLD 0.66
+struct OverlapEdge {
+    /**
+     * @brief Joined contig ends, ends[0] < ends[1].
+     */
+    uint32_t ends[2];
+
+    /**
+     * @brief Sum of the overlap lengths of the observations.
+     */
+    uint64_t weight;
+
+    /**
+     * @brief Best alignment of the anchor of ends[1 - k] to the contig end
+     * ends[k], nullptr if there is none.
+     */
+    const OverlapCandidate *observations[2];
+};
 
 
 /**
@@ -81,10 +149,33 @@ class Connector {
      * with contig that anchor belongs to. Procedure is repeated
      * until all contigs are processed.
      *
+     * When use_overlap_graph is set, the scaffolds are instead built from a
+     * graph of contig end overlaps, see build_graph_scaffolds. When
+     * use_end_index is set, overlaps are found with a minimizer index of the
+     * anchors instead of the aligner, see evaluate_index_overlaps.
+     *
      * @param trim_circular_genome flag to enable/disable trimming excessive
      * bases from circular genomes
+     * @param use_overlap_graph flag to enable the overlap graph connector
+     * @param use_end_index flag to find overlaps without the aligner
      */
-    void connect_contigs(bool trim_circular_genome);
+    void connect_contigs(bool trim_circular_genome,
+                         bool use_overlap_graph = false,
+                         bool use_end_index = false);
+
+
+    /**
+     * @brief Sets the read links used to bridge scaffolds.
+     * @details When set, connect_contigs joins the scaffolds built from
+     * overlaps through gaps bridged by reads, see bridge_scaffolds. The
+     * contig ends of the links must refer to the indices of the contigs
+     * passed to the constructor.
+     *
+     * @param read_links read links, must outlive connect_contigs
+     */
+    void set_read_links(const vector<bridge::ReadLink> *read_links) {
+        read_links_ = read_links;
+    }
 
 
     /**
@@ -107,7 +198,7 @@ class Connector {
  private:
     /**
      * Contig as reference filename during extension
-     * process for bwa tool.
+     * process for bwa tool, formatted with the worker index.
      */
     static const char* tmp_reference_file;
 
@@ -119,7 +210,7 @@ class Connector {
 
     /**
      * Filename for storing alignment results
-     * obtained by bwa tool.
+     * obtained by bwa tool, formatted with the worker index.
      */
     static const char* tmp_alignment_file;
 
@@ -130,16 +221,56 @@ class Connector {
     const vector<Contig*>& contigs_;
 
     /**
-     * @brief IDs set of used contigs in process.
+     * @brief Map from contig ID to its index in the contigs vector.
+     */
+    unordered_map<string, uint32_t> contig_idx_;
+
+    /**
+     * @brief Orientation of each contig, true if reverse complemented.
+     */
+    vector<bool> is_reversed_;
+
+    /**
+     * @brief Overlap candidates of the right end of each contig, indexed by
+     * orientation and contig index.
+     */
+    vector<vector<OverlapCandidate>> candidates_[2];
+
+    /**
+     * @brief Used state of each anchor, indexed by contig end.
+     */
+    vector<bool> used_anchors_;
+
+    /**
+     * @brief True for every contig placed in a scaffold.
+     */
+    vector<bool> is_placed_;
+
+    /**
+     * @brief Index of the next contig to consider as scaffold seed.
+     */
+    uint32_t next_seed_;
+
+    /**
+     * @brief Number of contigs not placed in a scaffold.
+     */
+    uint32_t num_free_;
+
+    /**
+     * @brief Union-find parent of each contig, contigs of the same scaffold
+     * share the root.
      */
-    unordered_set<string> used_ids_;
+    vector<uint32_t> parent_;
 
     /**
-     * @brief Map from ID to Contig. Unused contigs
-     * are only stored in this map.
+     * @brief Number of contigs in the set of each root.
      */
-    unordered_map<string, Contig*> unused_contigs;
+    vector<uint32_t> set_size_;
 
+    /**
+     * @brief Index in scaffolds of the scaffold of each root, -1 if none.
+     */
+    vector<int> scaffold_slot_;
 
     /**
      * @brief Current scaffold to merge next contigs into.
@@ -147,33 +278,51 @@ class Connector {
     Scaffold* curr;
 
     /**
-     * @brief Vector of scaffolds. Empty before connect_contigs
-     * function is called.
+     * @brief Read links used to bridge scaffolds, nullptr if none.
      */
-    vector<Scaffold*> scaffolds;
+    const vector<bridge::ReadLink> *read_links_;
 
     /**
-     * @brief Map from ContigID to Scaffold. So that information
-     * about which contig belongs to which scaffold is memorized.
+     * @brief Contigs created from the gap sequences of bridged scaffolds.
+     */
+    vector<Contig*> gap_contigs_;
+
+    /**
+     * @brief Vector of scaffolds. Empty before connect_contigs
+     * function is called. Slots of scaffolds merged into others are set to
+     * nullptr until connect_contigs removes them.
      */
-    unordered_map<string, Scaffold*> contig_to_scaffold;
+    vector<Scaffold*> scaffolds;
 
     /**
      * @brief Creates new Scaffold from next unused Contig
      * @details New Scaffold object is created if there is
-     * at least one unused contig in previously created scaffolds.
+     * at least one unused contig in previously created scaffolds. Seeds
+     * are taken in the order of the contigs, contigs shorter than
+     * MINIMUM_CONTIG_LEN are not used as seeds. The scaffold is appended
+     * to scaffolds.
      * @return New scaffold object or nullptr if all contigs are used.
      */
     Scaffold* create_scaffold();
 
 
     /**
-     * @brief Method finds Contig with id given as parameter.
+     * @brief Finds the union-find root of a contig.
      *
-     * @param id Contig id.
-     * @return Contig object if exists, nullptr otherwise.
+     * @param idx contig index
+     * @return Index of the root contig.
      */
-    Contig* find_contig(const string& id);
+    uint32_t find_root(uint32_t idx);
+
+
+    /**
+     * @brief Joins the union-find sets of two contigs.
+     *
+     * @param a contig index
+     * @param b contig index
+     * @return Index of the root of the joined set.
+     */
+    uint32_t unite(uint32_t a, uint32_t b);
 
 
     /**
@@ -187,6 +336,82 @@ class Connector {
     bool connect_next();
 
 
+    /**
+     * @brief Computes the contributions of two contigs joined by an
+     * overlap.
+     * @details The overlap is given by the alignment of the anchor of the
+     * next contig to the right end of the current contig, both contigs
+     * oriented as in the scaffold.
+     *
+     * @param curr_len length of the current contig
+     * @param next_ext_left length of the left extension of the next contig
+     * @param candidate alignment of the anchor of the next contig
+     * @param plast_end pointer to the contribution end of the current contig
+     * @param pthis_start pointer to the contribution start of the next
+     * contig
+     */
+    static void compute_join(int curr_len, int next_ext_left,
+                             const OverlapCandidate& candidate,
+                             int *plast_end, int *pthis_start);
+
+
+    /**
+     * @brief Builds the overlap graph of the contig ends.
+     * @details Every overlap candidate which passes should_connect and whose
+     * anchor faces the aligned contig end adds an observation to the edge of
+     * the two contig ends. Edges are sorted by decreasing weight, ties are
+     * broken by the contig end indices.
+     *
+     * @return Edges of the overlap graph.
+     */
+    vector<OverlapEdge> build_overlap_graph() const;
+
+
+    /**
+     * @brief Creates the scaffolds as paths of the overlap graph.
+     * @details Edges are accepted greedily by decreasing weight if both of
+     * their contig ends are still free and the edge does not close a cycle,
+     * so that every accepted edge is the best remaining edge of both of its
+     * ends. The resulting paths are walked starting from the free end with
+     * the lowest index, contigs are reverse complemented where needed.
+     * Unconnected contigs shorter than MINIMUM_CONTIG_LEN are skipped as in
+     * the greedy walk. The output does not depend on hash order.
+     */
+    void build_graph_scaffolds();
+
+
+    /**
+     * @brief Finds the contig end at an end of a scaffold.
+     *
+     * @param scaffold scaffold
+     * @param side end of the scaffold
+     * @return Index of the contig end, see OverlapEdge.
+     */
+    uint32_t scaffold_end(Scaffold *scaffold, ContigSide side);
+
+
+    /**
+     * @brief Reverse complements a scaffold and updates the orientation of
+     * its contigs.
+     *
+     * @param scaffold scaffold to reverse complement
+     */
+    void reverse_scaffold(Scaffold *scaffold);
+
+
+    /**
+     * @brief Joins scaffolds whose end contigs are bridged by reads.
+     * @details Edges of the read link graph are accepted greedily by
+     * decreasing read support if they join free ends of two different
+     * scaffolds. The scaffolds are oriented so that the joined ends face each
+     * other. The extensions at the joined contig ends are replaced by the
+     * consensus of the bridging reads, which is added to the scaffold as a
+     * contig of its own. If the draft contigs overlap, the overlap is removed
+     * from the next contig instead.
+     */
+    void bridge_scaffolds();
+
+
     /**
      * @brief Method checks if contig should be connected with
      * contig represented by record in alignment file.
@@ -204,8 +429,85 @@ class Connector {
     bool should_connect(Contig *contig, const BamAlignmentRecord& record);
 
 
+    /**
+     * @brief Method checks if an in process overlap of an anchor with the
+     * end of a contig extends the contig.
+     * @details Same criterion as for the alignment records, the anchor has
+     * to extend right of the contig end.
+     *
+     * @param anchor_len length of the anchor
+     * @param end_overlap overlap of the anchor prefix with the contig end
+     *
+     * @return True if contigs should be connected, false otherwise.
+     */
+    static bool should_connect(uint32_t anchor_len,
+                               const overlap::EndOverlap& end_overlap);
+
+
+    /**
+     * @brief Computes the overlap candidates of every contig.
+     * @details Anchors are aligned to both orientations of each contig,
+     * i.e. to both contig ends. The alignments are run concurrently on a
+     * pool of workers, each worker using its own temporary files.
+     */
+    void evaluate_overlaps();
+
+
+    /**
+     * @brief Computes the overlap candidates of every contig without the
+     * aligner.
+     * @details The right ends of both orientations of each contig are
+     * queried against a minimizer index of the anchors in batches of
+     * END_INDEX_BATCH_SIZE contigs. Every hit is verified with a banded
+     * alignment, see find_index_candidates.
+     *
+     * @param anchors anchors of all contigs
+     */
+    void evaluate_index_overlaps(const AnchorSet& anchors);
+
+
+    /**
+     * @brief Verifies the index hits of a single contig end.
+     * @details The anchor of each hit is aligned to the contig suffix
+     * starting at the approximate hit offset. Verified overlaps become
+     * candidates in the order of the hits, i.e. of the anchors, as the
+     * alignment records of find_overlap_candidates.
+     *
+     * @param idx contig index
+     * @param reverse True if the contig should be reverse complemented.
+     * @param end_begin position of the queried end in the oriented contig
+     * @param hits index hits of the queried end
+     * @param anchors anchors of all contigs
+     *
+     * @return Overlap candidates of the right end of the oriented contig.
+     */
+    vector<OverlapCandidate> find_index_candidates(uint32_t idx, bool reverse,
+                                                   uint32_t end_begin,
+                                                   const vector<EndHit>& hits,
+                                                   const AnchorSet& anchors);
+
+
+    /**
+     * @brief Aligns the anchors to a single contig and evaluates the
+     * alignments.
+     *
+     * @param contig Contig used as reference.
+     * @param reverse True if the contig should be reverse complemented.
+     * @param worker_id Index of the worker, used for temporary files.
+     *
+     * @return Overlap candidates of the right end of the oriented contig.
+     */
+    vector<OverlapCandidate> find_overlap_candidates(Contig *contig,
+                                                     bool reverse,
+                                                     uint32_t worker_id);
+
+
     /**
      * @brief Method trims scaffold at its ends if scaffold is circular.
+     * @details The left anchor of the first contig is overlapped in process
+     * with the end of the last contig, see overlap::find_end_overlap. The
+     * scaffold is circular if the anchor extends right of the last contig as
+     * required by should_connect.
      *
      * @param scaffold Scaffold to check for cicularity and correct
      * if neccessary.
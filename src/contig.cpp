@@ -19,15 +19,14 @@
 
 
 using std::string;
-using std::swap;
 
 
-Contig::Contig() {}
+Contig::Contig(): is_reversed_(false) {}
 
 
 Contig::Contig(Dna5String& seq,
                int total_ext_left,
-               int total_ext_right): seq_(seq) {
+               int total_ext_right): seq_(seq), is_reversed_(false) {
     total_ext_left_ = total_ext_left;
     total_ext_right_ = total_ext_right;
 
@@ -42,7 +41,7 @@ Contig::Contig(Dna5String& seq,
 
 Contig::Contig(const Dna5String& contig_seq,
                string& left_extension,
-               string &right_extension) {
+               string &right_extension): is_reversed_(false) {
     seq_ = left_extension;
     seq_ += contig_seq;
     seq_ += right_extension;
@@ -70,45 +69,81 @@ void Contig::set_id(const CharString& id) {
 }
 
 
-Dna5String Contig::anchor_left() {
-    String<char, CStyle> tmp = seq_;
-    string seq(tmp);
+// copies the bases of a slice in the slice orientation
+static Dna5String copy_slice(const SequenceSlice& slice) {
+    const Dna5String& seq = *slice.seq;
 
-    // if the contig is too short to create a significant anchor return the
-    // complete sequence
-    if (total_len() < 2 * ANCHOR_LEN + total_ext_left() + total_ext_right()) {
-        return seq;
+    Dna5String result;
+    resize(result, slice.end - slice.begin);
+
+    for (uint32_t i = 0; i < slice.end - slice.begin; ++i) {
+        if (slice.reverse) {
+            result[i] = bases::complement(
+                static_cast<char>(seq[slice.end - 1 - i]));
+        } else {
+            result[i] = seq[slice.begin + i];
+        }
     }
 
-    Dna5String anchor = seq.substr(0, total_ext_left() + ANCHOR_LEN);
-    return anchor;
+    return result;
 }
 
 
-Dna5String Contig::anchor_right() {
-    String<char, CStyle> tmp = seq_;
-    string seq(tmp);
+// reverse complement of a string
+static string complement_string(const string& seq) {
+    string result(seq.rbegin(), seq.rend());
+    for (auto& base : result) {
+        base = bases::complement(base);
+    }
+    return result;
+}
+
+
+Dna5String Contig::seq() const {
+    if (!is_reversed_) {
+        return seq_;
+    }
+
+    return copy_slice(slice(0, total_len()));
+}
+
+
+SequenceSlice Contig::slice(int begin, int end) const {
+    if (!is_reversed_) {
+        return {&seq_, static_cast<uint32_t>(begin),
+                static_cast<uint32_t>(end), false};
+    }
 
+    return {&seq_, static_cast<uint32_t>(total_len() - end),
+            static_cast<uint32_t>(total_len() - begin), true};
+}
+
+
+string Contig::ext_left() const {
+    return is_reversed_ ? complement_string(ext_right_) : ext_left_;
+}
+
+
+string Contig::ext_right() const {
+    return is_reversed_ ? complement_string(ext_left_) : ext_right_;
+}
+
+
+SequenceSlice Contig::anchor_slice(ContigSide side) const {
     // if the contig is too short to create a significant anchor return the
     // complete sequence
     if (total_len() < 2 * ANCHOR_LEN + total_ext_left() + total_ext_right()) {
-        return seq;
+        return slice(0, total_len());
+    }
+
+    if (side == LEFT) {
+        return slice(0, total_ext_left() + ANCHOR_LEN);
     }
 
-    Dna5String anchor = seq.substr(seq.length() - total_ext_right()
-        - ANCHOR_LEN);
-    return anchor;
+    return slice(total_len() - total_ext_right() - ANCHOR_LEN, total_len());
 }
 
 
 void Contig::reverse_complement() {
-    string contig_str = utility::reverse_complement(seq_);
-    seq_ = contig_str;
-
-    swap(total_ext_left_, total_ext_right_);
-    swap(left_id_, right_id_);
-
-    ext_left_ = contig_str.substr(0, total_ext_left_);
-    ext_right_ = contig_str.substr(contig_str.length() - total_ext_right_,
-                                   total_ext_right_);
+    is_reversed_ = !is_reversed_;
 }
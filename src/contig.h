@@ -34,6 +34,52 @@ using seqan::StringSet;
 // inserted in anchor
 #define ANCHOR_LEN 10000
 
+
+/**
+ * @brief Enum used to distinguish the two ends of a contig.
+ */
+enum ContigSide {
+    LEFT = 0,
+    RIGHT = 1
+};
+
+
+/**
+ * @brief Identifies one end of a contig.
+ * @details A contig end is identified by the index of the contig in the draft
+ * genome and the side of the contig.
+ */
+struct ContigEnd {
+    /**
+     * @brief Index of the contig in the draft genome.
+     */
+    uint32_t contig_idx;
+
+    /**
+     * @brief Side of the contig.
+     */
+    ContigSide side;
+
+    /**
+     * @brief Operator == overload
+     * @return True if both objects denote the same contig end.
+     */
+    bool operator==(const ContigEnd& other) const {
+        return contig_idx == other.contig_idx && side == other.side;
+    }
+};
+
+
+/**
+ * @brief Hash function for ContigEnd objects, used as template argument of
+ * unordered containers.
+ */
+struct ContigEndHash {
+    size_t operator()(const ContigEnd& end) const {
+        return (static_cast<size_t>(end.contig_idx) << 1) | end.side;
+    }
+};
+
 /**
  * @brief Contig class represent contig sequences.
  * @details Contig class is wrapper for
@@ -78,9 +124,37 @@ class Contig {
 
     /**
      * @brief Getter for extended contig sequence.
+     * @details The sequence is copied in the current orientation, reverse
+     * complemented contigs compute the complement on each call.
      * @return Contig extended sequence.
      */
-    Dna5String& seq() { return seq_; }
+    Dna5String seq() const;
+
+
+    /**
+     * @brief Getter for the stored contig sequence.
+     * @return Contig extended sequence in the original orientation.
+     */
+    const Dna5String& forward_seq() const { return seq_; }
+
+
+    /**
+     * @brief Checks the orientation of the contig.
+     * @return True if the contig is reverse complemented.
+     */
+    bool is_reversed() const { return is_reversed_; }
+
+
+    /**
+     * @brief Returns a view of a part of the contig sequence.
+     * @details Positions are given in the current orientation and mapped to
+     * the stored sequence, no bases are copied.
+     *
+     * @param begin index of the first base
+     * @param end index one past the last base
+     * @return Slice of the stored sequence.
+     */
+    SequenceSlice slice(int begin, int end) const;
 
 
     /**
@@ -94,21 +168,25 @@ class Contig {
      * @brief Getter for total length of extended contig sequence.
      * @return Length of extended contig sequence.
      */
-    int total_len() { return length(seq_); }
+    int total_len() const { return length(seq_); }
 
 
     /**
      * @brief Getter for length of left extension.
      * @return Length of left extension
      */
-    int total_ext_left() { return total_ext_left_; }
+    int total_ext_left() const {
+        return is_reversed_ ? total_ext_right_ : total_ext_left_;
+    }
 
 
     /**
      * @brief Getter for length of right extension.
      * @return Length of right extension.
      */
-    int total_ext_right() { return total_ext_right_; }
+    int total_ext_right() const {
+        return is_reversed_ ? total_ext_left_ : total_ext_right_;
+    }
 
 
     /**
@@ -117,35 +195,39 @@ class Contig {
      * @return Start index of right extension in extended
      * contig sequence.
      */
-    int right_ext_pos() { return total_len() - total_ext_right(); }
+    int right_ext_pos() const { return total_len() - total_ext_right(); }
 
 
     /**
      * @brief Getter for left extension.
      * @return Contig left extension.
      */
-    string& ext_left() { return ext_left_; }
+    string ext_left() const;
 
 
     /**
      * @brief Getter for right extension.
      * @return Contig right extension.
      */
-    string& ext_right() { return ext_right_; }
+    string ext_right() const;
 
 
     /**
      * @brief Getter for left extension id.
      * @return Left extension id.
      */
-    CharString& left_id() { return left_id_; }
+    const CharString& left_id() const {
+        return is_reversed_ ? right_id_ : left_id_;
+    }
 
 
     /**
      * @brief Getter for right extension id.
      * @return Right extension id.
      */
-    CharString& right_id() { return right_id_; }
+    const CharString& right_id() const {
+        return is_reversed_ ? left_id_ : right_id_;
+    }
 
 
     /**
@@ -158,34 +240,24 @@ class Contig {
 
     /**
      * @brief Method reverse complements this contig.
-     * @details Extended sequence is reversed and complemented.
-     * Left and right extensions data is updated from this
-     * reverse complemented sequence.
+     * @details Only the orientation of the contig is flipped, the stored
+     * sequence is kept. Positions, extensions and ids are reported for the
+     * current orientation, bases are complemented when they are read.
      */
     void reverse_complement();
 
 
     /**
-     * @brief Method creates left and right anchor from contigs
-     * and dumps them to file.
+     * @brief Returns a view of an anchor of the contig.
+     * @details The anchor of a side is the extension of that side followed
+     * or preceded by ANCHOR_LEN bases of the original contig. If the contig
+     * is too short to create a significant anchor the whole contig is used.
+     * The side and the positions refer to the current orientation.
      *
-     * @param contigs contigs used for creation of anchors
-     * @param anchors_file output file to dump the anchors
-     */
-    static void dump_anchors(const vector< Contig *>& contigs,
-                             const char *anchors_file) {
-        StringSet<Dna5String> anchors;
-        StringSet<CharString> ids;
-
-        for (auto contig : contigs) {
-            appendValue(ids, contig->left_id());
-            appendValue(anchors, contig->anchor_left());
-            appendValue(ids, contig->right_id());
-            appendValue(anchors, contig->anchor_right());
-        }
-
-        utility::write_fasta(ids, anchors, anchors_file);
-    }
+     * @param side side of the anchor
+     * @return Slice of the stored sequence.
+     */
+    SequenceSlice anchor_slice(ContigSide side) const;
 
 
     /**
@@ -206,41 +278,25 @@ class Contig {
     }
 
  private:
-    /**
-     * @brief Creates left anchor of contig.
-     * @details Left anchor is created so that subsequence[0, ANCHOR_LEN]
-     * of original contig sequence is appended on left extension.
-     * @return Left contig anchor.
-     */
-    Dna5String anchor_left();
-
-
-    /**
-     * @brief Creates right anchor of contig.
-     * @details Right extension is created so that right extension
-     * is appended on subsequence[LEN - ANCHOR_LEN, LEN] of original
-     * contig sequence.
-     * @return Right contig anchor.
-     */
-    Dna5String anchor_right();
-
     // Contig id
     CharString id_;
-    // Extended contig sequence
+    // Extended contig sequence in the original orientation
     Dna5String seq_;
+    // True if the contig is reverse complemented
+    bool is_reversed_;
 
-    // Left extension id
+    // Left extension id, in the original orientation
     CharString left_id_;
-    // Left extension length
+    // Left extension length, in the original orientation
     int total_ext_left_;
-    // Left extension sequence
+    // Left extension sequence, in the original orientation
     string ext_left_;
 
-    // Right extension id
+    // Right extension id, in the original orientation
     CharString right_id_;
-    // Right extension length
+    // Right extension length, in the original orientation
     int total_ext_right_;
-    // Right extension sequence.
+    // Right extension sequence, in the original orientation
     string ext_right_;
 };
 
@@ -0,0 +1,171 @@
+/**
+ * @file edit_distance.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the bit-parallel edit distance functions.
+ * @details Implementation file for the bit-parallel edit distance functions.
+ * The pattern is split into blocks of 64 rows, each column of the dynamic
+ * programming matrix is stored as vertical positive and negative delta
+ * vectors, and the horizontal delta is carried between blocks.
+ */
+#include <vector>
+#include <algorithm>
+
+#include "edit_distance.h"
+#include "base_tables.h"
+
+
+using std::vector;
+
+
+/**
+ * @brief Number of rows processed in one block
+ */
+#define WORD_SIZE 64
+
+/**
+ * @brief Mask of the highest bit in a block
+ */
+#define HIGH_BIT (1ULL << (WORD_SIZE - 1))
+
+
+namespace edit_distance {
+
+
+typedef uint64_t word;
+
+
+// computes one block of a column given the horizontal delta entering the
+// block from above, returns the horizontal delta leaving the block at the
+// given row
+static inline int compute_block(word *pv, word *mv, word eq, int hin,
+                                word out_mask) {
+    word hin_negative = hin < 0 ? 1 : 0;
+    word xv = eq | *mv;
+    eq |= hin_negative;
+    word xh = (((eq & *pv) + *pv) ^ *pv) | eq;
+    word ph = *mv | ~(xh | *pv);
+    word mh = *pv & xh;
+
+    int hout = ((ph & out_mask) ? 1 : 0) - ((mh & out_mask) ? 1 : 0);
+
+    ph = (ph << 1) | (hin > 0 ? 1 : 0);
+    mh = (mh << 1) | hin_negative;
+
+    *pv = mh | ~(xv | ph);
+    *mv = ph & xv;
+
+    return hout;
+}
+
+
+bool align_prefix(const char *pattern, uint32_t pattern_len, const char *text,
+                  uint32_t text_len, uint32_t max_distance,
+                  PrefixAlignment *presult) {
+    return align_prefix_banded(pattern, pattern_len, text, text_len,
+                               max_distance, UINT32_MAX, presult);
+}
+
+
+bool align_prefix_banded(const char *pattern, uint32_t pattern_len,
+                         const char *text, uint32_t text_len,
+                         uint32_t max_distance, uint32_t band,
+                         PrefixAlignment *presult) {
+    uint32_t num_blocks = (pattern_len + WORD_SIZE - 1) / WORD_SIZE;
+    uint32_t last_row = (pattern_len - 1) % WORD_SIZE;
+    word last_mask = 1ULL << last_row;
+
+    // match vectors of every base code for every block
+    vector<word> peq(NUM_BASE_CODES * num_blocks, 0);
+    for (uint32_t i = 0; i < pattern_len; ++i) {
+        uint8_t code = bases::encode(pattern[i]);
+        if (code != BASE_N_IDX) {
+            peq[code * num_blocks + i / WORD_SIZE] |= 1ULL << (i % WORD_SIZE);
+        }
+    }
+
+    vector<word> pv(num_blocks, ~0ULL);
+    vector<word> mv(num_blocks, 0);
+    // value of the last row of every block in the current column
+    vector<uint32_t> scores(num_blocks);
+
+    // only the blocks holding rows within the band of column 0 are active,
+    // a block entering the band below starts from the last active block
+    // plus one per row, an upper bound of its values
+    uint32_t first_block = 0;
+    uint32_t last_block = std::min<uint64_t>(num_blocks - 1,
+                                             (uint64_t) band / WORD_SIZE);
+    for (uint32_t b = 0; b <= last_block; ++b) {
+        scores[b] = std::min((b + 1) * WORD_SIZE, pattern_len);
+    }
+
+    uint32_t best_score = UINT32_MAX;
+    uint32_t best_end = 0;
+    if (last_block == num_blocks - 1 && pattern_len <= band) {
+        best_score = pattern_len;
+    }
+
+    uint64_t max_end = std::min<uint64_t>(
+        text_len, std::min<uint64_t>((uint64_t) pattern_len + max_distance,
+                                     (uint64_t) pattern_len + band));
+
+    for (uint32_t j = 0; j < max_end; ++j) {
+        const word *eq = peq.data() + bases::encode(text[j]) * num_blocks;
+        uint64_t column = j + 1;
+
+        // blocks whose rows all lie below the band enter it one at a time
+        uint64_t band_end = (column + band - 1) / WORD_SIZE;
+        if (last_block + 1 < num_blocks && band_end > last_block) {
+            ++last_block;
+            pv[last_block] = ~0ULL;
+            mv[last_block] = 0;
+            scores[last_block] = scores[last_block - 1] +
+                std::min((last_block + 1) * WORD_SIZE, pattern_len) -
+                last_block * WORD_SIZE;
+        }
+
+        // blocks whose rows all lie above the band are no longer computed
+        while (first_block < last_block &&
+               (uint64_t) (first_block + 1) * WORD_SIZE + band < column) {
+            ++first_block;
+        }
+
+        // the first row of the matrix is D[0][j] = j, the row above a
+        // later first block is assumed to grow by one per column
+        int hin = 1;
+        for (uint32_t b = first_block; b <= last_block; ++b) {
+            word out_mask = b + 1 == num_blocks ? last_mask : HIGH_BIT;
+            hin = compute_block(&pv[b], &mv[b], eq[b], hin, out_mask);
+            scores[b] += hin;
+        }
+
+        if (last_block + 1 < num_blocks) {
+            continue;
+        }
+
+        uint32_t score = scores[num_blocks - 1];
+
+        if (score < best_score) {
+            best_score = score;
+            best_end = j + 1;
+        }
+
+        // remaining columns can decrease the score by at most one each
+        if (score > max_distance + (max_end - j - 1)) {
+            break;
+        }
+    }
+
+    if (best_score > max_distance) {
+        return false;
+    }
+
+    presult->distance = best_score;
+    presult->text_end = best_end;
+
+    return true;
+}
+
+
+}  // namespace edit_distance
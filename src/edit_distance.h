@@ -0,0 +1,89 @@
+/**
+ * @file edit_distance.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the bit-parallel edit distance functions.
+ * @details Header file for the bit-parallel edit distance functions. Edit
+ * distances are computed with Myers' bit-vector algorithm, in the block-based
+ * formulation by Hyyro, which processes 64 cells of a dynamic programming
+ * column in a single machine word.
+ */
+#ifndef EDIT_DISTANCE_H
+#define EDIT_DISTANCE_H
+
+#include <cstdint>
+
+
+/**
+ * @brief Namespace for edit distance functions
+ */
+namespace edit_distance {
+
+
+/**
+ * @brief Result of aligning a pattern to a prefix of a text.
+ */
+struct PrefixAlignment {
+    /**
+     * @brief edit distance between the pattern and the text prefix
+     */
+    uint32_t distance;
+
+    /**
+     * @brief length of the text prefix the pattern is aligned to
+     */
+    uint32_t text_end;
+};
+
+
+/**
+ * @brief Aligns the whole pattern to the best prefix of the text.
+ * @details Computes min over q of the edit distance between the pattern and
+ * text[0, q). Only prefixes of length at most pattern_len + max_distance are
+ * considered, longer prefixes can not be within the distance bound. When
+ * several prefixes have the minimal distance the shortest one is reported.
+ *
+ * @param pattern pattern bases
+ * @param pattern_len number of pattern bases, must be positive
+ * @param text text bases
+ * @param text_len number of text bases
+ * @param max_distance maximum accepted edit distance
+ * @param presult pointer to the output alignment
+ *
+ * @return True if an alignment within max_distance exists, false otherwise.
+ */
+bool align_prefix(const char *pattern, uint32_t pattern_len, const char *text,
+                  uint32_t text_len, uint32_t max_distance,
+                  PrefixAlignment *presult);
+
+
+/**
+ * @brief Aligns the whole pattern to the best prefix of the text in a band.
+ * @details Same as align_prefix, but in every text column only the blocks
+ * of pattern rows within band rows of the main diagonal are computed, so the
+ * cost grows with the band instead of with the pattern length. Cells outside
+ * the band are replaced by an upper bound, so the reported distance never
+ * underestimates the true one and is exact whenever band is at least
+ * max_distance.
+ *
+ * @param pattern pattern bases
+ * @param pattern_len number of pattern bases, must be positive
+ * @param text text bases
+ * @param text_len number of text bases
+ * @param max_distance maximum accepted edit distance
+ * @param band maximum distance of a computed row from the main diagonal
+ * @param presult pointer to the output alignment
+ *
+ * @return True if an alignment within max_distance exists, false otherwise.
+ */
+bool align_prefix_banded(const char *pattern, uint32_t pattern_len,
+                         const char *text, uint32_t text_len,
+                         uint32_t max_distance, uint32_t band,
+                         PrefixAlignment *presult);
+
+
+}  // namespace edit_distance
+
+
+#endif  // EDIT_DISTANCE_H
@@ -0,0 +1,179 @@
+/**
+ * @file end_index.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the EndIndex class.
+ * @details Implementation file for the EndIndex class.
+ */
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "end_index.h"
+#include "overlap.h"
+#include "resources.h"
+#include "thread_pool.h"
+
+
+using std::string;
+using std::vector;
+
+
+namespace {
+
+
+// minimizer shared by a query and an anchor
+struct Seed {
+    uint32_t anchor_idx;
+    bool is_complement;
+    int64_t diagonal;
+    uint32_t anchor_pos;
+
+    bool operator<(const Seed& other) const {
+        if (anchor_idx != other.anchor_idx) {
+            return anchor_idx < other.anchor_idx;
+        }
+        if (is_complement != other.is_complement) {
+            return is_complement < other.is_complement;
+        }
+        return diagonal < other.diagonal;
+    }
+};
+
+
+}  // namespace
+
+
+EndIndex::EndIndex(const AnchorSet& anchors): anchors_(anchors) {
+    vector<vector<minimizers::Minimizer>> anchor_minimizers(anchors.size());
+
+    {
+        ThreadLease lease(WORKER_THREADS, utility::get_concurrency_level());
+        ThreadPool pool(lease.threads());
+
+        for (uint32_t i = 0; i < anchors.size(); ++i) {
+            pool.submit([this, i, &anchor_minimizers] (uint32_t) {
+                const SequenceSlice& slice = anchors_[i].slice;
+                string seq = utility::slice_to_string(slice, 0,
+                                                      anchors_[i].length());
+                minimizers::find_minimizers(seq.data(), seq.length(),
+                                            MINIMIZER_K, MINIMIZER_W, true,
+                                            &anchor_minimizers[i]);
+            });
+        }
+
+        pool.wait();
+    }
+
+    uint64_t total = 0;
+    for (auto const& minimizers : anchor_minimizers) {
+        total += minimizers.size();
+    }
+    entries_.reserve(total);
+
+    for (uint32_t i = 0; i < anchors.size(); ++i) {
+        for (auto const& minimizer : anchor_minimizers[i]) {
+            entries_.push_back({minimizer.hash, i,
+                                minimizer.pos << 1 | minimizer.reverse});
+        }
+        vector<minimizers::Minimizer>().swap(anchor_minimizers[i]);
+    }
+
+    std::sort(entries_.begin(), entries_.end(),
+              [](const Entry& a, const Entry& b) {
+        return a.hash < b.hash;
+    });
+}
+
+
+void EndIndex::query(const vector<SequenceSlice>& queries,
+                     vector<vector<EndHit>> *phits) const {
+    auto& hits = *phits;
+    hits.assign(queries.size(), vector<EndHit>());
+
+    // buffers reused by all queries of the batch
+    vector<minimizers::Minimizer> query_minimizers;
+    vector<Seed> seeds;
+
+    auto by_hash = [](const Entry& entry, uint64_t hash) {
+        return entry.hash < hash;
+    };
+
+    for (uint32_t q = 0; q < queries.size(); ++q) {
+        const SequenceSlice& slice = queries[q];
+        string seq = utility::slice_to_string(slice, 0,
+                                              slice.end - slice.begin);
+
+        query_minimizers.clear();
+        minimizers::find_minimizers(seq.data(), seq.length(), MINIMIZER_K,
+                                    MINIMIZER_W, true, &query_minimizers);
+
+        seeds.clear();
+        for (auto const& minimizer : query_minimizers) {
+            auto first = std::lower_bound(entries_.begin(), entries_.end(),
+                                          minimizer.hash, by_hash);
+            auto last = first;
+            while (last != entries_.end() && last->hash == minimizer.hash) {
+                ++last;
+            }
+
+            // repetitive minimizers only add spurious seeds
+            if (last - first > END_INDEX_MAX_OCCURRENCES) {
+                continue;
+            }
+
+            for (auto it = first; it != last; ++it) {
+                uint32_t pos = it->pos_strand >> 1;
+                bool is_complement = (it->pos_strand & 1) != minimizer.reverse;
+
+                // position of the k-mer in the oriented anchor
+                if (is_complement) {
+                    pos = anchors_[it->anchor_idx].length() - pos -
+                          MINIMIZER_K;
+                }
+
+                seeds.push_back({it->anchor_idx, is_complement,
+                                 static_cast<int64_t>(minimizer.pos) - pos,
+                                 pos});
+            }
+        }
+
+        std::sort(seeds.begin(), seeds.end());
+
+        for (uint32_t begin = 0, end = 0; begin < seeds.size(); begin = end) {
+            // seeds of the same anchor and strand
+            end = begin;
+            while (end < seeds.size() &&
+                   seeds[end].anchor_idx == seeds[begin].anchor_idx &&
+                   seeds[end].is_complement == seeds[begin].is_complement) {
+                ++end;
+            }
+
+            uint32_t best_begin = begin, best_count = 0;
+            for (uint32_t i = begin, j = begin; j < end; ++j) {
+                while (seeds[j].diagonal - seeds[i].diagonal >
+                       OVERLAP_DIAGONAL_BAND) {
+                    ++i;
+                }
+                if (j - i + 1 > best_count) {
+                    best_count = j - i + 1;
+                    best_begin = i;
+                }
+            }
+
+            if (best_count < OVERLAP_MIN_HITS) {
+                continue;
+            }
+
+            auto first = std::min_element(seeds.begin() + best_begin,
+                seeds.begin() + best_begin + best_count,
+                [](const Seed& a, const Seed& b) {
+                    return a.anchor_pos < b.anchor_pos;
+                });
+
+            hits[q].push_back({first->anchor_idx, first->is_complement,
+                               first->diagonal, best_count});
+        }
+    }
+}
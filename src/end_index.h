@@ -0,0 +1,136 @@
+/**
+ * @file end_index.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the EndIndex class.
+ * @details Header file for the EndIndex class. The index stores the canonical
+ * minimizers of all extended contig ends, i.e. the anchors, and finds the
+ * anchors which share a diagonal of minimizers with a queried sequence. This
+ * replaces aligning every anchor to every contig when looking for joins.
+ */
+#ifndef END_INDEX_H
+#define END_INDEX_H
+
+#include <vector>
+#include <cstdint>
+
+#include "anchors.h"
+#include "minimizers.h"
+#include "utility.h"
+
+
+using std::vector;
+
+
+/**
+ * @brief Minimizers occurring more often in the anchors are not used as seeds
+ */
+#define END_INDEX_MAX_OCCURRENCES 64
+
+/**
+ * @brief Number of contigs whose ends are queried as a single batch
+ */
+#define END_INDEX_BATCH_SIZE 256
+
+
+/**
+ * @brief Anchor sharing minimizers with a queried sequence.
+ */
+struct EndHit {
+    /**
+     * @brief Index of the anchor in the AnchorSet.
+     */
+    uint32_t anchor_idx;
+
+    /**
+     * @brief True if the anchor matches the reverse complement of the query.
+     */
+    bool is_complement;
+
+    /**
+     * @brief Approximate position of the first anchor base in the query, may
+     * be outside of the query. The anchor is reverse complemented first if
+     * is_complement is set.
+     */
+    int64_t offset;
+
+    /**
+     * @brief Number of minimizers supporting the hit.
+     */
+    uint32_t num_hits;
+};
+
+
+/**
+ * @brief Minimizer index over the extended contig ends.
+ */
+class EndIndex {
+ public:
+    /**
+     * @brief EndIndex class constructor.
+     * @details Minimizers of the anchors are computed in parallel and sorted
+     * by hash.
+     *
+     * @param anchors anchors to index, must outlive the index
+     */
+    explicit EndIndex(const AnchorSet& anchors);
+
+
+    /**
+     * @brief Getter for the number of indexed minimizers.
+     * @return Number of minimizers in the index.
+     */
+    uint64_t size() const { return entries_.size(); }
+
+
+    /**
+     * @brief Finds the anchors overlapping a batch of sequences.
+     * @details Shared minimizers are grouped by anchor, strand and diagonal.
+     * For each anchor and strand the densest group within
+     * OVERLAP_DIAGONAL_BAND is reported if it has at least OVERLAP_MIN_HITS
+     * minimizers, its offset is taken from the minimizer closest to the
+     * anchor start. Hits of each query are ordered by anchor index.
+     *
+     * @param queries sequences to query
+     * @param phits pointer to the output hits, one vector per query
+     */
+    void query(const vector<SequenceSlice>& queries,
+               vector<vector<EndHit>> *phits) const;
+
+ private:
+    /**
+     * @brief Minimizer of an anchor.
+     */
+    struct Entry {
+        /**
+         * @brief hash of the canonical k-mer
+         */
+        uint64_t hash;
+
+        /**
+         * @brief index of the anchor
+         */
+        uint32_t anchor_idx;
+
+        /**
+         * @brief position of the k-mer in the anchor shifted left by one,
+         * the lowest bit is set if the canonical k-mer is the reverse
+         * complement
+         */
+        uint32_t pos_strand;
+    };
+
+    /**
+     * @brief Indexed anchors.
+     */
+    const AnchorSet& anchors_;
+
+    /**
+     * @brief Minimizers of all anchors sorted by hash.
+     */
+    vector<Entry> entries_;
+};
+
+
+#endif  // END_INDEX_H
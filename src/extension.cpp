@@ -2,27 +2,105 @@
  * @file extension.cpp
  * @copyright Marko Culinovic <marko.culinovic@gmail.com>
  * @copyright Luka Sterbic <luka.sterbic@gmail.com>
- * @brief Implementation file for Extension class
- * @details Implementation file for Extension class. It is used as representation
- * of possible extension reads of contig. It provides functionality
- * for local realignment method used in contig extension process.
+ * @brief Implementation file for ExtensionSet class
+ * @details Implementation file for ExtensionSet class. It is used as
+ * representation of all possible extension reads of one contig end. It
+ * provides functionality for local realignment method used in contig
+ * extension process.
  */
 
 #include <string>
+#include <vector>
+#include <algorithm>
 
 #include "extension.h"
 
 
 using std::string;
+using std::vector;
+using std::min;
+using std::reverse_copy;
 
 
-Extension::Extension(uint32_t read_id, const string& seq,
-                     bool drop): is_droped(drop),
-                                 read_id_(read_id),
-                                 seq_(seq),
-                                 curr_pos_(0) {}
+ExtensionSet::ExtensionSet() {}
 
 
-void Extension::do_operation(const Operation& op) {
-    curr_pos_ += op;
+uint32_t ExtensionSet::push_entry(uint32_t read_id, uint32_t len,
+                                  bool drop) {
+    uint32_t idx = size();
+    uint32_t offset = arena_.size();
+
+    if ((idx & 63) == 0) {
+        dropped_.push_back(0);
+    }
+
+    offsets_.push_back(offset);
+    lengths_.push_back(len);
+    cursors_.push_back(0);
+    read_ids_.push_back(read_id);
+
+    if (drop) {
+        this->drop(idx);
+    }
+
+    arena_.resize(offset + len);
+    qualities_.resize(offset + len, DEFAULT_QUALITY);
+    return offset;
+}
+
+
+// converts an ASCII encoded quality to a Phred value
+static inline uint8_t decode_quality(char quality) {
+    int phred = quality - PHRED_OFFSET;
+    return std::max(0, std::min(phred, MAX_QUALITY));
+}
+
+
+void ExtensionSet::add(uint32_t read_id, const char *bases, uint32_t len,
+                       bool drop, const char *quals) {
+    uint32_t offset = push_entry(read_id, len, drop);
+    std::copy(bases, bases + len, arena_.begin() + offset);
+
+    if (quals != nullptr) {
+        std::transform(quals, quals + len, qualities_.begin() + offset,
+                       decode_quality);
+    }
+}
+
+
+void ExtensionSet::add_reversed(uint32_t read_id, const char *bases,
+                                uint32_t len, bool drop, const char *quals) {
+    uint32_t offset = push_entry(read_id, len, drop);
+    reverse_copy(bases, bases + len, arena_.begin() + offset);
+
+    if (quals != nullptr) {
+        std::transform(quals, quals + len, qualities_.begin() + offset,
+                       decode_quality);
+        std::reverse(qualities_.begin() + offset,
+                     qualities_.begin() + offset + len);
+    }
+}
+
+
+string ExtensionSet::extension(uint32_t idx, uint32_t max_len) const {
+    return string(seq(idx), min(max_len, length(idx)));
+}
+
+
+void ExtensionSet::remove_dropped() {
+    ExtensionSet kept;
+
+    for (uint32_t i = 0; i < size(); ++i) {
+        if (!is_dropped(i)) {
+            uint32_t offset = kept.push_entry(read_ids_[i], lengths_[i],
+                                              false);
+            std::copy(seq(i), seq(i) + lengths_[i],
+                      kept.arena_.begin() + offset);
+            std::copy(quals(i), quals(i) + lengths_[i],
+                      kept.qualities_.begin() + offset);
+            kept.cursors_.back() = cursors_[i];
+        }
+    }
+
+    std::swap(*this, kept);
 }
@@ -2,19 +2,39 @@
  * @file extension.h
  * @author Marko Culinovic <marko.culinovic@gmail.com>
  * @author Luka Sterbic <luka.sterbic@gmail.com>
- * @brief Header file for Extension class
- * @details Header file for Extension class. It is used as representation
- * of possible extension reads of contig. It provides functionality
- * for local realignment method used in contig extension process.
+ * @brief Header file for ExtensionSet class
+ * @details Header file for ExtensionSet class. It is used as representation
+ * of all possible extension reads of one contig end. It provides
+ * functionality for local realignment method used in contig extension
+ * process.
  */
 
 #ifndef EXTENSION_H
 #define EXTENSION_H
 
 #include <string>
+#include <vector>
+#include <cstdint>
 
 
 using std::string;
+using std::vector;
+
+
+/**
+ * @brief Offset of the ASCII encoding of Phred qualities in FASTQ and SAM
+ */
+#define PHRED_OFFSET 33
+
+/**
+ * @brief Highest Phred quality representable in FASTQ and SAM
+ */
+#define MAX_QUALITY 93
+
+/**
+ * @brief Phred quality assigned to bases of reads without qualities
+ */
+#define DEFAULT_QUALITY 10
 
 
 /**
@@ -30,40 +50,149 @@ enum Operation {
 
 
 /**
- * @brief Extension class.
- * @details Extension class is used as representation
- * of possible extension reads of contig. It provides functionality
- * for local realignment method used in process.
+ * @brief ExtensionSet class.
+ * @details ExtensionSet stores the possible extension reads of one contig end
+ * as a structure of arrays. Bases of all extensions are stored back to back
+ * in a single arena, while offsets into the arena, lengths, current positions
+ * and read IDs are kept in parallel arrays and the dropped state in a bitmap.
+ * Phred qualities are stored as one byte per base in a second arena at the
+ * same offsets as the bases. The hot loops of the extension process thus
+ * walk contiguous memory instead of dereferencing one heap object per read.
  */
-class Extension {
+class ExtensionSet {
  public:
     /**
-     * @brief Extension class constructor.
+     * @brief ExtensionSet class default constructor.
+     */
+    ExtensionSet();
+
+
+    /**
+     * @brief Adds an extension to the set.
      *
      * @param read_id Id of read that is possible extension.
-     * @param seq Subsequence of read sequence that is possible extension.
+     * @param bases Subsequence of read sequence that is possible extension.
+     * @param len Number of bases.
      * @param drop Bool value that representes if this read is dropped.
+     * @param quals ASCII encoded Phred qualities of the bases, nullptr if the
+     * read has no qualities
      */
-    Extension(uint32_t read_id, const string& seq, bool drop);
+    void add(uint32_t read_id, const char *bases, uint32_t len, bool drop,
+             const char *quals = nullptr);
+
+
+    /**
+     * @brief Adds an extension to the set storing its bases in reverse.
+     * @details Used for left extensions which are consumed right to left.
+     *
+     * @param read_id Id of read that is possible extension.
+     * @param bases Subsequence of read sequence that is possible extension.
+     * @param len Number of bases.
+     * @param drop Bool value that representes if this read is dropped.
+     * @param quals ASCII encoded Phred qualities of the bases, nullptr if the
+     * read has no qualities
+     */
+    void add_reversed(uint32_t read_id, const char *bases, uint32_t len,
+                      bool drop, const char *quals = nullptr);
+
+
+    /**
+     * @brief Getter for number of extensions.
+     * @return Number of extensions in the set.
+     */
+    uint32_t size() const { return read_ids_.size(); }
+
 
     /**
      * @brief Getter for read Id.
+     *
+     * @param idx index of the extension
      * @return Read Id.
      */
-    uint32_t read_id() { return read_id_; }
+    uint32_t read_id(uint32_t idx) const { return read_ids_[idx]; }
+
 
     /**
-     * @brief Getter for possible extension sequence.
-     * @return Extension sequence.
+     * @brief Getter for the bases of an extension.
+     *
+     * @param idx index of the extension
+     * @return Pointer to the first base of the extension.
      */
-    const string& seq() { return seq_; }
+    const char *seq(uint32_t idx) const {
+        return arena_.data() + offsets_[idx];
+    }
+
+
+    /**
+     * @brief Getter for the qualities of an extension.
+     *
+     * @param idx index of the extension
+     * @return Pointer to the Phred quality of the first base of the extension.
+     */
+    const uint8_t *quals(uint32_t idx) const {
+        return qualities_.data() + offsets_[idx];
+    }
+
+
+    /**
+     * @brief Getter for the length of an extension.
+     *
+     * @param idx index of the extension
+     * @return Number of bases in the extension.
+     */
+    uint32_t length(uint32_t idx) const { return lengths_[idx]; }
+
 
     /**
      * @brief Getter for current position in extension
      * durring extension process.
+     *
+     * @param idx index of the extension
      * @return Index of current position in extension sequence.
      */
-    uint32_t curr_pos() { return curr_pos_; }
+    uint32_t curr_pos(uint32_t idx) const { return cursors_[idx]; }
+
+
+    /**
+     * @brief Copies the bases of an extension.
+     *
+     * @param idx index of the extension
+     * @param max_len maximum number of bases to copy
+     * @return Extension sequence.
+     */
+    string extension(uint32_t idx, uint32_t max_len) const;
+
+
+    /**
+     * @brief Checks if an extension is dropped.
+     *
+     * @param idx index of the extension
+     * @return True if the extension is dropped, false otherwise.
+     */
+    bool is_dropped(uint32_t idx) const {
+        return (dropped_[idx >> 6] >> (idx & 63)) & 1;
+    }
+
+
+    /**
+     * @brief Marks an extension as dropped.
+     *
+     * @param idx index of the extension
+     */
+    void drop(uint32_t idx) { dropped_[idx >> 6] |= 1ULL << (idx & 63); }
+
+
+    /**
+     * @brief Reactivates a dropped extension at the given position.
+     *
+     * @param idx index of the extension
+     * @param position new current position in the extension sequence
+     */
+    void restore(uint32_t idx, uint32_t position) {
+        dropped_[idx >> 6] &= ~(1ULL << (idx & 63));
+        cursors_[idx] = position;
+    }
+
 
     /**
      * @brief Local realignment operation executor
@@ -71,31 +200,83 @@ class Extension {
      * in extension sequence is moved ahead by 1 or 2 or
      * remains unchanged.
      *
+     * @param idx index of the extension
      * @param op Alignment operation.
      */
-    void do_operation(const Operation& op);
+    void do_operation(uint32_t idx, const Operation& op) {
+        cursors_[idx] += op;
+    }
+
 
     /**
-     * @brief True if the extension is dropped, false otherwise.
+     * @brief Removes all dropped extensions from the set.
+     * @details Current positions of the remaining extensions are kept.
      */
-    bool is_droped;
+    void remove_dropped();
+
 
- private:
     /**
-     * @brief Integer read ID.
+     * @brief Getter for the base arena.
+     * @return Bases of all extensions.
      */
-    uint32_t read_id_;
+    const char *arena() const { return arena_.data(); }
+
 
     /**
-     * @brief Sequence of the extension.
+     * @brief Getter for the quality arena.
+     * @return Phred qualities of all extensions, at the offsets of the bases.
      */
-    string seq_;
+    const uint8_t *quality_arena() const { return qualities_.data(); }
+
 
     /**
-     * @brief Current position in the extension sequence during consensus
-     * computation in contig extension.
+     * @brief Getter for the arena offsets of all extensions.
+     * @return Array of offsets.
      */
-    uint32_t curr_pos_;
+    const uint32_t *offsets() const { return offsets_.data(); }
+
+
+    /**
+     * @brief Getter for the lengths of all extensions.
+     * @return Array of lengths.
+     */
+    const uint32_t *lengths() const { return lengths_.data(); }
+
+
+    /**
+     * @brief Getter for the current positions of all extensions.
+     * @return Array of current positions.
+     */
+    const uint32_t *cursors() const { return cursors_.data(); }
+
+
+    /**
+     * @brief Getter for the dropped state bitmap.
+     * @return Bitmap with one bit per extension, set if dropped.
+     */
+    const uint64_t *dropped_bitmap() const { return dropped_.data(); }
+
+ private:
+    /**
+     * @brief Adds a new entry with the given length and returns the offset
+     * of its first base in the arena.
+     */
+    uint32_t push_entry(uint32_t read_id, uint32_t len, bool drop);
+
+    // bases of all extensions
+    vector<char> arena_;
+    // Phred quality of each base in the arena
+    vector<uint8_t> qualities_;
+    // offset of the first base of each extension in the arena
+    vector<uint32_t> offsets_;
+    // number of bases of each extension
+    vector<uint32_t> lengths_;
+    // current position in each extension
+    vector<uint32_t> cursors_;
+    // read id of each extension
+    vector<uint32_t> read_ids_;
+    // dropped state of each extension, one bit per extension
+    vector<uint64_t> dropped_;
 };
 
 #endif  // EXTENSION_H
@@ -0,0 +1,112 @@
+/**
+ * @file extension_cache.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the ExtensionCache class.
+ * @details Implementation file for the ExtensionCache class.
+ */
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "extension_cache.h"
+#include "utility.h"
+
+
+// FNV-1a offset basis and primes of the two lanes
+#define HASH_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define HASH_PRIME_0 0x100000001b3ULL
+#define HASH_PRIME_1 0x9e3779b97f4a7c15ULL
+
+
+ContentHash::ContentHash() {
+    lanes_[0] = HASH_OFFSET_BASIS;
+    lanes_[1] = HASH_OFFSET_BASIS;
+}
+
+
+void ContentHash::mix(const char *data, uint64_t len) {
+    for (uint64_t i = 0; i < len; ++i) {
+        uint8_t byte = data[i];
+        lanes_[0] = (lanes_[0] ^ byte) * HASH_PRIME_0;
+        lanes_[1] = (lanes_[1] ^ byte) * HASH_PRIME_1;
+    }
+}
+
+
+void ContentHash::update(const char *data, uint64_t len) {
+    update(static_cast<int64_t>(len));
+    mix(data, len);
+}
+
+
+void ContentHash::update(int64_t value) {
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>(static_cast<uint64_t>(value) >> (8 * i));
+    }
+    mix(bytes, sizeof(bytes));
+}
+
+
+string ContentHash::hex() const {
+    char buffer[33];
+    snprintf(buffer, sizeof(buffer), "%016llx%016llx",
+             static_cast<unsigned long long>(lanes_[0]),
+             static_cast<unsigned long long>(lanes_[1]));
+    return string(buffer);
+}
+
+
+ExtensionCache::ExtensionCache(const string& directory):
+        directory_(directory) {
+    if (enabled()) {
+        utility::execute_command("mkdir -p %th", directory_.c_str());
+    }
+}
+
+
+bool ExtensionCache::load(const string& key, string *pleft,
+                          string *pright) const {
+    std::ifstream in(directory_ + "/" + key);
+    if (!in) {
+        return false;
+    }
+
+    string magic;
+    if (!std::getline(in, magic) || magic != EXTENSION_CACHE_MAGIC) {
+        return false;
+    }
+
+    return std::getline(in, *pleft) && std::getline(in, *pright);
+}
+
+
+void ExtensionCache::store(const string& key, const string& left,
+                           const string& right) const {
+    string filename = directory_ + "/" + key;
+
+    // unique per process and thread
+    std::ostringstream tmp_filename;
+    tmp_filename << filename << ".tmp." << getpid() << "."
+        << std::this_thread::get_id();
+
+    {
+        std::ofstream out(tmp_filename.str());
+        out << EXTENSION_CACHE_MAGIC << '\n' << left << '\n' << right << '\n';
+
+        if (!out) {
+            utility::exit_with_message("Could not write file %s",
+                                       tmp_filename.str().c_str());
+        }
+    }
+
+    if (std::rename(tmp_filename.str().c_str(), filename.c_str()) != 0) {
+        utility::exit_with_message("Could not write file %s",
+                                   filename.c_str());
+    }
+}
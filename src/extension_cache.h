@@ -0,0 +1,142 @@
+/**
+ * @file extension_cache.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the ExtensionCache class.
+ * @details Header file for the ExtensionCache class. The cache stores the
+ * extensions of contigs in a directory, one file per result named after a
+ * hash of all inputs of the extension. Runs with the same contig, reads and
+ * settings find the result of an earlier run instead of extending the contig
+ * again. Each cache file holds the EXTENSION_CACHE_MAGIC line followed by
+ * the left and the right extension, one per line.
+ */
+#ifndef EXTENSION_CACHE_H
+#define EXTENSION_CACHE_H
+
+#include <string>
+#include <cstdint>
+
+
+using std::string;
+
+
+/**
+ * @brief First line of every cache file, includes the format version
+ */
+#define EXTENSION_CACHE_MAGIC "EAGLCACHE 1"
+
+
+/**
+ * @brief Hash of the contents of multiple fields.
+ * @details Two independent 64 bit FNV-1a lanes are combined into a 128 bit
+ * hash. Every field is prefixed with its length, so that different splits of
+ * the same bytes give different hashes.
+ */
+class ContentHash {
+ public:
+    /**
+     * @brief ContentHash class constructor.
+     */
+    ContentHash();
+
+
+    /**
+     * @brief Adds a field to the hash.
+     *
+     * @param data field bytes
+     * @param len number of bytes
+     */
+    void update(const char *data, uint64_t len);
+
+
+    /**
+     * @brief Adds a string field to the hash.
+     *
+     * @param field field to add
+     */
+    void update(const string& field) { update(field.data(), field.length()); }
+
+
+    /**
+     * @brief Adds an integer field to the hash.
+     *
+     * @param value field to add
+     */
+    void update(int64_t value);
+
+
+    /**
+     * @brief Getter for the hash.
+     * @return Hash as 32 hexadecimal digits.
+     */
+    string hex() const;
+
+ private:
+    /**
+     * @brief Adds bytes to both lanes.
+     */
+    void mix(const char *data, uint64_t len);
+
+    /**
+     * @brief State of the two hash lanes.
+     */
+    uint64_t lanes_[2];
+};
+
+
+/**
+ * @brief Directory of cached contig extensions.
+ * @details Results are written to a temporary file which is then renamed, so
+ * concurrent workers and runs sharing the directory never see partial
+ * results.
+ */
+class ExtensionCache {
+ public:
+    /**
+     * @brief ExtensionCache class constructor.
+     * @details The directory is created if it does not exist.
+     *
+     * @param directory path to the cache directory, empty to disable the
+     * cache
+     */
+    explicit ExtensionCache(const string& directory);
+
+
+    /**
+     * @brief Checks if the cache is used.
+     * @return True if a cache directory has been set, false otherwise.
+     */
+    bool enabled() const { return !directory_.empty(); }
+
+
+    /**
+     * @brief Loads a cached extension.
+     *
+     * @param key hash of the extension inputs
+     * @param pleft pointer to the left extension
+     * @param pright pointer to the right extension
+     * @return True if the result is cached, false otherwise.
+     */
+    bool load(const string& key, string *pleft, string *pright) const;
+
+
+    /**
+     * @brief Stores an extension.
+     *
+     * @param key hash of the extension inputs
+     * @param left left extension
+     * @param right right extension
+     */
+    void store(const string& key, const string& left,
+               const string& right) const;
+
+ private:
+    /**
+     * @brief Path to the cache directory.
+     */
+    string directory_;
+};
+
+
+#endif  // EXTENSION_CACHE_H
@@ -0,0 +1,131 @@
+/**
+ * @file incremental.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the incremental namespace.
+ * @details Implementation file for the incremental namespace.
+ */
+#include <fstream>
+#include <vector>
+#include <string>
+
+#include "incremental.h"
+#include "extension.h"
+#include "extension_cache.h"
+#include "scaffolder.h"
+
+
+using seqan::length;
+
+
+namespace incremental {
+
+
+string draft_key(const StringSet<CharString>& contig_ids,
+                 const StringSet<Dna5String>& contig_seqs) {
+    ContentHash hash;
+
+    for (uint32_t i = 0; i < length(contig_seqs); ++i) {
+        hash.update(utility::CharString_to_string(contig_ids[i]));
+        hash.update(utility::Dna5String_to_string(contig_seqs[i]));
+    }
+
+    return hash.hex();
+}
+
+
+bool load_batches(const string& output_base, StateKeys *pkeys,
+                  vector<Batch> *pbatches) {
+    auto& keys = *pkeys;
+    auto& batches = *pbatches;
+    batches.clear();
+
+    string filename = output_base + STATE_MANIFEST_FILE;
+    std::ifstream in(filename);
+    if (!in) {
+        return false;
+    }
+
+    string line;
+    std::getline(in, line);
+
+    size_t first_tab = line.find('\t');
+    size_t second_tab = line.find('\t', first_tab + 1);
+    if (first_tab == string::npos || second_tab == string::npos ||
+        line.compare(0, first_tab, "keys") != 0) {
+        utility::exit_with_message("Malformed state manifest %s",
+                                   filename.c_str());
+    }
+
+    keys.draft = line.substr(first_tab + 1, second_tab - first_tab - 1);
+    keys.settings = line.substr(second_tab + 1);
+
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        size_t tab = line.find('\t');
+        if (tab == string::npos) {
+            utility::exit_with_message("Malformed state manifest %s",
+                                       filename.c_str());
+        }
+
+        batches.push_back({line.substr(0, tab), line.substr(tab + 1)});
+    }
+
+    return true;
+}
+
+
+void save_batches(const string& output_base, const StateKeys& keys,
+                  const vector<Batch>& batches) {
+    string filename = output_base + STATE_MANIFEST_FILE;
+    std::ofstream out(filename);
+    if (!out) {
+        utility::exit_with_message("Could not open file %s", filename.c_str());
+    }
+
+    out << "keys" << '\t' << keys.draft << '\t' << keys.settings << '\n';
+
+    for (auto const& batch : batches) {
+        out << batch.reads_file << '\t' << batch.alignment_file << '\n';
+    }
+
+    if (!out) {
+        utility::exit_with_message("Could not write file %s",
+                                   filename.c_str());
+    }
+}
+
+
+void find_changed_ends(const AlignmentCollection& new_alignments,
+                       const StringSet<Dna5String>& contig_seqs,
+                       const unordered_map<string, uint32_t>& read_name_to_id,
+                       vector<char> *pleft_changed,
+                       vector<char> *pright_changed) {
+    auto& left_changed = *pleft_changed;
+    auto& right_changed = *pright_changed;
+
+    left_changed.assign(length(contig_seqs), false);
+    right_changed.assign(length(contig_seqs), false);
+
+    for (auto const& contig_alns : new_alignments) {
+        uint32_t i = contig_alns.first;
+
+        ExtensionSet left_extensions;
+        ExtensionSet right_extensions;
+        scaffolder::find_possible_extensions(contig_alns.second,
+                                             &left_extensions,
+                                             &right_extensions,
+                                             read_name_to_id,
+                                             length(contig_seqs[i]));
+
+        left_changed[i] = left_extensions.size() > 0;
+        right_changed[i] = right_extensions.size() > 0;
+    }
+}
+
+
+}  // namespace incremental
@@ -0,0 +1,151 @@
+/**
+ * @file incremental.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the incremental namespace.
+ * @details Header file for the incremental namespace. It provides functions
+ * used to store the state of a run next to its output files and to update
+ * that state when a new batch of reads arrives. The state consists of the
+ * extended contigs, stored as a single shard file, the alignment files of
+ * all read batches and a manifest listing the processed batches.
+ *
+ * The manifest is a text file. Its first line holds the word keys, the key
+ * of the draft genome and the key of the extension settings of the run that
+ * wrote it. Every further line describes one batch, holding the absolute
+ * path of the reads file and the path of its alignment file. All fields are
+ * separated by a tab character.
+ */
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <seqan/sequence.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "utility.h"
+
+
+using std::vector;
+using std::string;
+using std::unordered_map;
+
+using seqan::StringSet;
+using seqan::Dna5String;
+using seqan::CharString;
+
+
+/**
+ * @brief Name of the manifest file, appended to the output base
+ */
+#define STATE_MANIFEST_FILE "state.batches"
+
+/**
+ * @brief Name of the extended contigs file, appended to the output base
+ */
+#define STATE_CONTIGS_FILE "state.bin"
+
+/**
+ * @brief Name format of the batch alignment files, appended to the output
+ * base
+ */
+#define STATE_ALIGNMENT_FILE "state_%u.sam"
+
+
+/**
+ * @brief Namespace for incremental runs.
+ */
+namespace incremental {
+
+
+/**
+ * @brief A batch of reads processed by an earlier run.
+ */
+struct Batch {
+    /**
+     * @brief Absolute path of the reads file.
+     */
+    string reads_file;
+
+    /**
+     * @brief Path of the alignment of the reads to the draft genome.
+     */
+    string alignment_file;
+};
+
+
+/**
+ * @brief Inputs of a run that the stored extensions depend on.
+ */
+struct StateKeys {
+    /**
+     * @brief Key of the draft genome, see draft_key.
+     */
+    string draft;
+
+    /**
+     * @brief Key of the extension settings, see scaffolder::settings_key.
+     */
+    string settings;
+};
+
+
+/**
+ * @brief Computes the key of the draft genome.
+ * @details The key is a hash of the identifiers and sequences of all
+ * contigs in draft genome order.
+ *
+ * @param contig_ids identifiers of the contigs of the draft genome
+ * @param contig_seqs contigs of the draft genome
+ * @return Key of the draft genome.
+ */
+string draft_key(const StringSet<CharString>& contig_ids,
+                 const StringSet<Dna5String>& contig_seqs);
+
+
+/**
+ * @brief Reads the manifest of the stored state.
+ *
+ * @param output_base prefix of the output files
+ * @param pkeys pointer to the output keys of the stored state
+ * @param pbatches pointer to the output batches
+ * @return True if a state is stored, false otherwise.
+ */
+bool load_batches(const string& output_base, StateKeys *pkeys,
+                  vector<Batch> *pbatches);
+
+
+/**
+ * @brief Writes the manifest of the stored state.
+ *
+ * @param output_base prefix of the output files
+ * @param keys keys of the inputs of the stored state
+ * @param batches all processed batches
+ */
+void save_batches(const string& output_base, const StateKeys& keys,
+                  const vector<Batch>& batches);
+
+
+/**
+ * @brief Finds the contig ends with new extension evidence.
+ * @details An end changed if a new alignment could extend it or has been
+ * dropped at it, as decided by scaffolder::find_possible_extensions.
+ *
+ * @param new_alignments alignments of the new reads, keyed by contig index
+ * @param contig_seqs contigs of the draft genome
+ * @param read_name_to_id mapping from read name to read index
+ * @param pleft_changed pointer to the left end flags of every contig
+ * @param pright_changed pointer to the right end flags of every contig
+ */
+void find_changed_ends(const AlignmentCollection& new_alignments,
+                       const StringSet<Dna5String>& contig_seqs,
+                       const unordered_map<string, uint32_t>& read_name_to_id,
+                       vector<char> *pleft_changed,
+                       vector<char> *pright_changed);
+
+
+}  // namespace incremental
+
+
+#endif  // INCREMENTAL_H
@@ -11,17 +11,33 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <thread>
+#include <climits>
+#include <algorithm>
+#include <iterator>
+#include <unistd.h>
 
 #include "aligners/aligner.h"
 #include "utility.h"
 #include "scaffolder.h"
+#include "bases.h"
 #include "contig.h"
 #include "connector.h"
+#include "bridge.h"
+#include "poa_engine.h"
+#include "shard.h"
+#include "incremental.h"
+#include "extension_cache.h"
+#include "resources.h"
+#include "thread_pool.h"
+#include "collector.h"
+#include "progress.h"
 
 #define VERSION ("v1.0.1")
 #define RELEASE_DATE (string(__DATE__) + string(" at ") + string(__TIME__))
 
 #define PATH_BUFFER_SIZE 256
+#define POA_WINDOW_LEN 1000
 
 
 using std::cout;
@@ -34,6 +50,7 @@ using seqan::StringSet;
 using seqan::CharString;
 using seqan::Dna5String;
 using seqan::appendValue;
+using seqan::clear;
 using seqan::String;
 using seqan::CStyle;
 
@@ -45,13 +62,36 @@ char tmp_dirname[PATH_BUFFER_SIZE] = "tmp";
 char contigs_filename[PATH_BUFFER_SIZE] = { 0 };
 char extensions_filename[PATH_BUFFER_SIZE] = { 0 };
 char scaffolds_filename[PATH_BUFFER_SIZE] = { 0 };
+char output_base[PATH_BUFFER_SIZE] = { 0 };
+char *output_argument = nullptr;
 
 bool use_POA_consensus = false;
+int poa_window_len = POA_WINDOW_LEN;
+poa_backend::PoaBackend use_poa_backend = poa_backend::CppPoa;
 bool use_graphmap_aligner = false;
 bool trim_circular_genome = true;
+bool use_overlap_graph = false;
+bool use_end_index = false;
+bool use_read_bridges = false;
+bool use_incremental = false;
+// directory of the extension cache, empty if the cache is disabled
+string extension_cache_dir;
+
+// links of reads aligned to two contig ends, used to bridge scaffolds
+vector<bridge::ReadLink> read_links;
 
 read_type::ReadType use_tech_type = read_type::PacBio;
 
+// index of the shard run by this process, -1 if sharding is disabled
+int shard_idx = -1;
+uint32_t num_shards = 0;
+// number of shards to run as local processes before merging
+uint32_t local_shards = 0;
+// number of shards to merge
+uint32_t merge_shards = 0;
+// index in argv of the first positional argument
+int first_argument_idx = 0;
+
 
 void set_output_paths(char *output_argument) {
     string base_name(output_argument);
@@ -82,6 +122,15 @@ void set_output_paths(char *output_argument) {
 
     snprintf(scaffolds_filename, PATH_BUFFER_SIZE, "%s%cscaffolds.fasta",
              base_name.c_str(), delimiter);
+
+    snprintf(output_base, PATH_BUFFER_SIZE, "%s%c", base_name.c_str(),
+             delimiter);
+}
+
+
+string get_shard_filename(uint32_t idx) {
+    // output_base and absolute paths may exceed the sequence id buffer
+    return string(output_base) + "shard_" + std::to_string(idx) + ".bin";
 }
 
 
@@ -108,11 +157,68 @@ void setup_cmd_interface(int argc, char **argv) {
 
     parsero::set_footer(footer);
 
+    // option - set extension cache directory
+    parsero::add_option("C:",
+        "directory of the extension cache, reused by later runs, disabled by "
+        "default [path]",
+        [] (char *option) {
+            extension_cache_dir = utility::absolute_path(option); });
+
+    // option - enable incremental runs, hack to avoid unused variable warning
+    parsero::add_option("I",
+        "incremental run, extends only the contig ends with new evidence from "
+        "the given reads and stores the state next to the output [flag]",
+        [] (char *option) { use_incremental = true || option; });
+
+    // option - merge shards
+    parsero::add_option("M:",
+        "merge the extended contigs of the given number of shards [int]",
+        [] (char *option) {
+            if (atoi(option) <= 0) {
+                utility::exit_with_message("Illegal number of shards");
+            }
+            merge_shards = atoi(option);
+        });
+
+    // option - run shards as local processes
+    parsero::add_option("N:",
+        "run the given number of shards as local processes and merge them "
+        "[int]",
+        [] (char *option) {
+            if (atoi(option) <= 0) {
+                utility::exit_with_message("Illegal number of shards");
+            }
+            local_shards = atoi(option);
+        });
+
+    // option - run a single shard
+    parsero::add_option("P:",
+        "extend only the contigs of the given shard [shard_idx,num_shards]",
+        [] (char *option) {
+            if (sscanf(option, "%d,%u", &shard_idx, &num_shards) != 2 ||
+                shard_idx < 0 || num_shards == 0 ||
+                (uint32_t) shard_idx >= num_shards) {
+                utility::exit_with_message("Illegal shard format");
+            }
+        });
+
+    // option - enable read bridges, hack to avoid unused variable warning
+    parsero::add_option("b",
+        "join scaffolds through gaps bridged by reads, not available with "
+        "shards [flag]",
+        [] (char *option) { use_read_bridges = true || option; });
+
     // option - set minimum coverage
     parsero::add_option("c:",
         "minimum coverage to output an extension base [int]",
         [] (char *option) { scaffolder::set_min_coverage(atoi(option)); });
 
+    // option - set POA engine
+    parsero::add_option("e:",
+        "POA consensus engine, by default set to cpppoa [cpppoa, native]",
+        [] (char *option) {
+            use_poa_backend = poa_backend::string_to_poa_backend(option); });
+
     // option - enable graphmap aligner, hack to avoid unused variable warning
     parsero::add_option("g", "use GraphMap aligner [flag]",
         [] (char *option) { use_graphmap_aligner = true || option; });
@@ -121,11 +227,23 @@ void setup_cmd_interface(int argc, char **argv) {
     parsero::add_option("h", "print help message [flag]",
         [] (char *option) { option = option; });
 
+    // option - enable minimizer index of contig ends, hack to avoid unused
+    // variable warning
+    parsero::add_option("i",
+        "find contig overlaps with a minimizer index instead of the aligner "
+        "[flag]",
+        [] (char *option) { use_end_index = true || option; });
+
     // option - disable circular genome check, hack to avoid unused variable
     // warning
     parsero::add_option("k", "disable circular genome trimming [flag]",
         [] (char *option) { trim_circular_genome = false && option; });
 
+    // option - set lookahead depth
+    parsero::add_option("l:",
+        "realignment lookahead depth in bases, 0 disables [int]",
+        [] (char *option) { scaffolder::set_lookahead_depth(atoi(option)); });
+
     // option - set marginse
     parsero::add_option("m:",
         "inner and outer margin in base pairs [int,int]",
@@ -141,16 +259,39 @@ void setup_cmd_interface(int argc, char **argv) {
             }
         });
 
+    // option - enable overlap graph connector, hack to avoid unused variable
+    // warning
+    parsero::add_option("o",
+        "connect contigs through an overlap graph of contig ends [flag]",
+        [] (char *option) { use_overlap_graph = true || option; });
+
     // option - enable poa, hack to avoid unused variable warning
     parsero::add_option("p", "use POA consensus algorithm [flag]",
         [] (char *option) { use_POA_consensus = true || option; });
 
+    // option - enable quality weighted vote, hack to avoid unused variable
+    // warning
+    parsero::add_option("q", "use quality weighted majority vote, requires "
+        "FASTQ reads [flag]",
+        [] (char *option) {
+            option = option;
+            bases::set_vote_mode(bases::QUALITY_WEIGHTED_VOTE);
+        });
+
+    // option - set minimum realignment gain rate
+    parsero::add_option("r:",
+        "minimum extension bases gained per second of realignment, "
+        "0 (default) disables [float]",
+        [] (char *option) { scaffolder::set_min_gain_rate(atof(option)); });
+
     // option - set extension size
     parsero::add_option("s:", "maximum extension size in base pairs [int]",
         [] (char *option) { scaffolder::set_max_extension_len(atoi(option)); });
 
     // option - set number of threads
-    parsero::add_option("t:", "number of parallel threads [int]",
+    parsero::add_option("t:",
+        "number of threads shared by the aligner and the extension workers "
+        "[int]",
         [] (char *option) { utility::set_concurrency_level(atoi(option)); });
 
     // option - set number of threads
@@ -161,6 +302,16 @@ void setup_cmd_interface(int argc, char **argv) {
                 exit(0);
             });
 
+    // option - set POA window length
+    parsero::add_option("w:",
+        "POA consensus window length in base pairs, 0 disables [int]",
+        [] (char *option) {
+            poa_window_len = atoi(option);
+            if (poa_window_len < 0) {
+                utility::exit_with_message("Illegal POA window length");
+            }
+        });
+
     // option - set read type
     parsero::add_option("x:",
         "input reads type, by default set to PacBio [pacbio, ont]",
@@ -171,25 +322,56 @@ void setup_cmd_interface(int argc, char **argv) {
     parsero::add_argument("draft_genome.fasta",
         [] (char *filename) { draft_genome_filename = filename; });
     // argument - long reads in fasta format
-    parsero::add_argument("long_reads.fasta",
+    parsero::add_argument("long_reads.fasta/fastq",
         [] (char *filename) { reads_filename = filename; });
     // argument - output file in fasta format
     parsero::add_argument("output_prefix/output_dir",
-        [] (char *output_argument) { set_output_paths(output_argument); });
+        [] (char *argument) {
+            output_argument = argument;
+            set_output_paths(argument);
+        });
 
-    parsero::parse(argc, argv);
+    first_argument_idx = parsero::parse(argc, argv) - 3;
 }
 
 
-int main(int argc, char **argv) {
-    setup_cmd_interface(argc, argv);
+void init_aligner() {
+    Aligner::init(use_graphmap_aligner, use_tech_type);
+    const char *aligner_name = Aligner::get_instance().get_name().c_str();
 
-    if (reads_filename == nullptr || draft_genome_filename == nullptr) {
-        parsero::help(argv[0]);
-        exit(1);
+    if (!utility::is_command_available(aligner_name)) {
+        utility::exit_with_message("The %s aligner has not been detected!",
+                                   aligner_name);
     }
 
-    utility::execute_command("mkdir -p %th", tmp_dirname);
+    cout << "[ALIGNER] Initializing "<< aligner_name << " aligner..." << endl;
+}
+
+
+void append_reads(const char *filename, StringSet<CharString>* pids,
+                  StringSet<Dna5String>* pseqs,
+                  StringSet<CharString>* pquals) {
+    if (length(*pids) == 0) {
+        utility::read_sequences(pids, pseqs, pquals, filename);
+        return;
+    }
+
+    StringSet<CharString> ids;
+    StringSet<Dna5String> seqs;
+    StringSet<CharString> quals;
+    utility::read_sequences(&ids, &seqs, &quals, filename);
+
+    // reads without qualities are padded so that the sets stay aligned
+    for (uint32_t id = 0; id < length(ids); ++id) {
+        appendValue(*pids, ids[id]);
+        appendValue(*pseqs, seqs[id]);
+        appendValue(*pquals, id < length(quals) ? quals[id] : CharString());
+    }
+}
+
+
+void extend_draft_genome(vector<IndexedContig>* pcontigs) {
+    auto& contigs = *pcontigs;
 
     cout << "[INPUT] Reading draft genome: " << draft_genome_filename
         << endl;
@@ -206,12 +388,73 @@ int main(int argc, char **argv) {
         contig_name_to_id[contig_name] = id;
     }
 
-    cout << "[INPUT] Reading long reads: " << reads_filename << endl;
+    // batches of reads processed by earlier incremental runs
+    vector<incremental::Batch> batches;
+    incremental::StateKeys stored_keys;
+    bool has_state = use_incremental &&
+                     incremental::load_batches(output_base, &stored_keys,
+                                               &batches);
+
+    incremental::StateKeys state_keys;
+    if (use_incremental) {
+        state_keys.draft = incremental::draft_key(contig_ids, contig_seqs);
+    }
 
-    // read long reads from file
+    // alignments of earlier batches are only valid for the same draft genome
+    if (has_state && stored_keys.draft != state_keys.draft) {
+        utility::exit_with_message("Draft genome does not match the state in "
+                                   "%s" STATE_MANIFEST_FILE, output_base);
+    }
+    string new_reads_file = utility::absolute_path(reads_filename);
+
+    // read long reads from files, FASTA or FASTQ
     StringSet<CharString> read_ids;
     StringSet<Dna5String> read_seqs;
-    utility::read_fasta(&read_ids, &read_seqs, reads_filename);
+    StringSet<CharString> read_quals;
+
+    for (auto const& batch : batches) {
+        if (batch.reads_file == new_reads_file) {
+            utility::exit_with_message("Reads %s have already been processed",
+                                       reads_filename);
+        }
+
+        cout << "[INPUT] Reading long reads: " << batch.reads_file << endl;
+        append_reads(batch.reads_file.c_str(), &read_ids, &read_seqs,
+                     &read_quals);
+    }
+
+    cout << "[INPUT] Reading long reads: " << reads_filename << endl;
+    append_reads(reads_filename, &read_ids, &read_seqs, &read_quals);
+
+    // qualities are kept only if every read has them
+    if (!utility::has_qualities(read_seqs, read_quals)) {
+        clear(read_quals);
+
+        if (bases::get_vote_mode() == bases::QUALITY_WEIGHTED_VOTE) {
+            cout << "[INPUT] Reads have no qualities, using unweighted vote"
+                << endl;
+            bases::set_vote_mode(bases::UNWEIGHTED_VOTE);
+        }
+    }
+
+    // extension method and its own settings, part of the state and cache
+    // keys, the realignment rounds also depend on the aligner and its preset
+    string method = use_POA_consensus ?
+        utility::create_seq_id("poa|%d|%d", (int) use_poa_backend,
+                               poa_window_len) :
+        utility::create_seq_id("realign|%s|%s",
+                               use_graphmap_aligner ? "graphmap" : "bwa",
+                               use_tech_type == read_type::ONT ? "ont" :
+                                                                 "pacbio");
+    state_keys.settings = scaffolder::settings_key(method);
+
+    // extensions of earlier runs are reused only with the same settings
+    bool reuse_extensions = has_state;
+    if (has_state && stored_keys.settings != state_keys.settings) {
+        cout << "[INCREMENTAL] Extension settings changed, extending all "
+            "contig ends" << endl;
+        reuse_extensions = false;
+    }
 
     // create map<read_str_name, read_int_id>
     unordered_map<string, uint32_t> read_name_to_id;
@@ -221,66 +464,293 @@ int main(int argc, char **argv) {
         read_name_to_id[read_name_id] = id;
     }
 
-    // copy file to temporary folder to avoid data folder polution
-    utility::write_fasta(contig_ids, contig_seqs,
-                         Aligner::get_tmp_reference_filename());
+    int contigs_size = length(contig_ids);
 
+    // select the contigs extended by this process
+    vector<bool> is_selected(contigs_size, true);
+    const char *reference_filename = draft_genome_filename;
 
-    // initialize Aligner
-    Aligner::init(use_graphmap_aligner, use_tech_type);
-    const char *aligner_name = Aligner::get_instance().get_name().c_str();
+    if (shard_idx >= 0) {
+        auto assignment = shard::partition_contigs(contig_seqs, num_shards);
 
-    if (!utility::is_command_available(aligner_name)) {
-        utility::exit_with_message("The %s aligner has not been detected!",
-                                   aligner_name);
+        StringSet<CharString> shard_ids;
+        StringSet<Dna5String> shard_seqs;
+
+        for (int i = 0; i < contigs_size; ++i) {
+            is_selected[i] = assignment[i] == (uint32_t) shard_idx;
+
+            if (is_selected[i]) {
+                appendValue(shard_ids, contig_ids[i]);
+                appendValue(shard_seqs, contig_seqs[i]);
+            }
+        }
+
+        cout << "[SHARD] Shard [" << shard_idx + 1 << "/" << num_shards
+            << "] contains " << length(shard_ids) << " contigs" << endl;
+
+        // align reads only to the contigs of this shard
+        utility::write_fasta(shard_ids, shard_seqs,
+                             Aligner::get_tmp_reference_filename());
+        reference_filename = Aligner::get_tmp_reference_filename();
+    } else {
+        // copy file to temporary folder to avoid data folder polution
+        utility::write_fasta(contig_ids, contig_seqs,
+                             Aligner::get_tmp_reference_filename());
     }
 
-    cout << "[ALIGNER] Initializing "<< aligner_name << " aligner..." << endl;
+    init_aligner();
 
     // create index for all contigs in draft genome
     cout << "[ALIGNER] Creating index..." << endl;
 
-    Aligner::get_instance().index(draft_genome_filename);
+    Aligner::get_instance().index(reference_filename);
 
     // align all reads to the draft genome
     cout << "[ALIGNER] Aligning reads to draft genome using ";
     cout << utility::get_concurrency_level() << " threads..." << endl;
 
-    Aligner::get_instance().align(draft_genome_filename, reads_filename);
+    Aligner::get_instance().align(reference_filename, reads_filename);
 
     cout << "[ALIGNER] Creating alignments map..." << endl;
     AlignmentCollection contig_alns;
-    utility::map_alignments(Aligner::get_tmp_alignment_filename(), &contig_alns,
+
+    // alignments of earlier batches precede the new ones as in a full run
+    for (auto const& batch : batches) {
+        utility::map_alignments(batch.alignment_file.c_str(), &contig_alns,
+                                contig_name_to_id);
+    }
+
+    AlignmentCollection new_alns;
+    utility::map_alignments(Aligner::get_tmp_alignment_filename(), &new_alns,
                             contig_name_to_id);
 
-    StringSet<Dna5String> result_contig_seqs;
-    StringSet<Dna5String> extensions;
-    StringSet<CharString> ext_ids;
+    // ends without new evidence keep the extension of the earlier run
+    vector<char> left_changed(contigs_size, true);
+    vector<char> right_changed(contigs_size, true);
+    vector<IndexedContig> prior_contigs;
 
-    vector< Contig* > contigs;
-    int contigs_size = length(contig_ids);
+    if (reuse_extensions) {
+        incremental::find_changed_ends(new_alns, contig_seqs, read_name_to_id,
+                                       &left_changed, &right_changed);
+
+        string state_file = string(output_base) + STATE_CONTIGS_FILE;
+        shard::read_shard(state_file.c_str(), 1, &prior_contigs);
+
+        if (prior_contigs.size() != (size_t) contigs_size) {
+            utility::exit_with_message("Draft genome does not match the "
+                                       "state in %s", state_file.c_str());
+        }
+
+        std::sort(prior_contigs.begin(), prior_contigs.end(),
+            [] (const IndexedContig& a, const IndexedContig& b) {
+                return a.first < b.first;
+            });
+
+        uint32_t num_changed = 0;
+        for (int i = 0; i < contigs_size; ++i) {
+            is_selected[i] = left_changed[i] || right_changed[i];
+            num_changed += is_selected[i];
+        }
+
+        cout << "[INCREMENTAL] New reads change the ends of " << num_changed
+            << " out of " << contigs_size << " contigs" << endl;
+    }
+
+    if (use_incremental) {
+        // keep the alignment of the new reads for later runs
+        string alignment_file = utility::create_seq_id(
+            "%s" STATE_ALIGNMENT_FILE, output_base, batches.size());
+        utility::execute_command("cp %th %th",
+                                 Aligner::get_tmp_alignment_filename(),
+                                 alignment_file.c_str());
+
+        batches.push_back({new_reads_file, alignment_file});
+    }
+
+    for (auto& entry : new_alns) {
+        auto& records = contig_alns[entry.first];
+        records.insert(records.end(),
+                       std::make_move_iterator(entry.second.begin()),
+                       std::make_move_iterator(entry.second.end()));
+    }
+    new_alns.clear();
+
+    // bridges are harvested from the same alignments, without sharding only
+    if (use_read_bridges && shard_idx < 0) {
+        vector<uint32_t> contig_lens;
+        for (int i = 0; i < contigs_size; ++i) {
+            contig_lens.emplace_back(length(contig_seqs[i]));
+        }
+
+        bridge::find_read_links(contig_alns, contig_lens, read_name_to_id,
+                                read_seqs, &read_links);
+
+        cout << "[BRIDGE] Found " << read_links.size()
+            << " reads linking two contig ends" << endl;
+    }
+
+    // reuse the extensions of earlier runs with the same inputs
+    ExtensionCache cache(extension_cache_dir);
+    vector<string> cache_keys(contigs_size);
+    vector<pair<string, string>> cached_extensions(contigs_size);
+    vector<char> is_cached(contigs_size, false);
+
+    if (cache.enabled()) {
+        uint32_t num_cached = 0;
+        for (int i = 0; i < contigs_size; ++i) {
+            if (!is_selected[i]) {
+                continue;
+            }
+
+            cache_keys[i] = scaffolder::extension_key(contig_seqs[i],
+                                                      contig_alns[i],
+                                                      read_name_to_id,
+                                                      read_seqs, read_quals,
+                                                      method);
+            is_cached[i] = cache.load(cache_keys[i],
+                                      &cached_extensions[i].first,
+                                      &cached_extensions[i].second);
+            num_cached += is_cached[i];
+        }
+
+        cout << "[CACHE] Reusing " << num_cached << " cached extensions from "
+            << extension_cache_dir << endl;
+    }
 
     cout << "[EXTENDER] Contig extension algorithm: " << (use_POA_consensus
         ? "Partial Order Alignment" : "Local/Global Realign") << endl;
 
-    // attempt to extend each contig
+    // compute the POA consensus of all contig ends at once
+    ConsensusMap consensus;
+    if (use_POA_consensus) {
+        PoaEngine poa_engine(utility::get_concurrency_level(),
+                             poa_window_len, use_poa_backend);
+
+        for (int i = 0; i < contigs_size; ++i) {
+            if (!is_selected[i] || is_cached[i]) {
+                continue;
+            }
+
+            vector<string> left_extensions;
+            vector<string> right_extensions;
+
+            scaffolder::find_poa_extensions(contig_seqs[i], contig_alns[i],
+                                            read_name_to_id,
+                                            &left_extensions,
+                                            &right_extensions);
+
+            // unchanged ends are restored from the earlier run
+            if (!left_changed[i]) {
+                left_extensions.clear();
+            }
+            if (!right_changed[i]) {
+                right_extensions.clear();
+            }
+
+            poa_engine.add_job({(uint32_t) i, LEFT},
+                               std::move(left_extensions));
+            poa_engine.add_job({(uint32_t) i, RIGHT},
+                               std::move(right_extensions));
+        }
+
+        cout << "[EXTENDER] Computing POA consensus for "
+            << poa_engine.num_jobs() << " contig ends using "
+            << utility::get_concurrency_level() << " threads and the "
+            << (use_poa_backend == poa_backend::Native ? "native (" +
+                string(poa_kernel_name()) + ")" : string("cpppoa"))
+            << " engine..." << endl;
+
+        consensus = poa_engine.run();
+    }
+
+    // workers must not insert into the shared alignment collection
+    vector<uint32_t> selected_contigs;
     for (int i = 0; i < contigs_size; ++i) {
-        Dna5String contig_seq;
-        Contig *contig = nullptr;
-
-        cout << "[EXTENDER] Starting extension procedure for contig [" << i + 1
-            << "/" << contigs_size << "]: " << contig_ids[i] << endl;
-
-        if (use_POA_consensus) {
-            contig = scaffolder::extend_contig_poa(contig_seqs[i],
-                                                   contig_alns[i],
-                                                   read_name_to_id);
-        } else {
-            contig = scaffolder::extend_contig(contig_seqs[i], contig_alns[i],
-                                               read_name_to_id, read_ids,
-                                               read_seqs);
+        if (is_selected[i]) {
+            selected_contigs.emplace_back(i);
+            contig_alns[i];
         }
+    }
+
+    uint32_t num_tasks = selected_contigs.size();
+    ResultCollector<Contig*> results(num_tasks);
 
+    // realignment rounds of each task, written only by the task's worker
+    vector<vector<scaffolder::RoundStats>> round_stats(num_tasks);
+
+    // attempt to extend each contig
+    {
+        ProgressReporter progress("EXTENDER", "Extended contigs", num_tasks);
+
+        ThreadLease lease(WORKER_THREADS, utility::get_concurrency_level());
+        ThreadPool pool(lease.threads());
+
+        cout << "[EXTENDER] Extending " << num_tasks << " contigs using "
+            << pool.size() << " workers..." << endl;
+
+        for (uint32_t task = 0; task < num_tasks; ++task) {
+            pool.submit([&, task] (uint32_t worker_id) {
+                uint32_t i = selected_contigs[task];
+                Contig *contig = nullptr;
+
+                if (is_cached[i]) {
+                    contig = new Contig(contig_seqs[i],
+                                        cached_extensions[i].first,
+                                        cached_extensions[i].second);
+                } else if (use_POA_consensus) {
+                    contig = scaffolder::create_contig_poa(
+                        contig_seqs[i],
+                        consensus.at({i, LEFT}),
+                        consensus.at({i, RIGHT}));
+                } else {
+                    contig = scaffolder::extend_contig(contig_seqs[i],
+                                                       contig_alns.at(i),
+                                                       read_name_to_id,
+                                                       read_ids, read_seqs,
+                                                       read_quals,
+                                                       worker_id,
+                                                       &round_stats[task]);
+                }
+
+                // the POA consensus of an unchanged end is not computed,
+                // the key however covers the alignments of all batches
+                bool is_partial = use_POA_consensus &&
+                                  !(left_changed[i] && right_changed[i]);
+
+                if (cache.enabled() && !is_cached[i] && !is_partial) {
+                    cache.store(cache_keys[i], contig->ext_left(),
+                                contig->ext_right());
+                }
+
+                contig->set_id(contig_ids[i]);
+
+                results.store(task, std::move(contig));
+                progress.advance();
+            });
+        }
+
+        pool.wait();
+    }
+
+    // report and store the extended contigs in draft genome order
+    for (uint32_t task = 0; task < num_tasks; ++task) {
+        uint32_t i = selected_contigs[task];
+        Contig *contig = results.result(task);
+
+        if (reuse_extensions) {
+            Contig *prior = prior_contigs[i].second;
+            string left = left_changed[i] ? contig->ext_left() :
+                                            prior->ext_left();
+            string right = right_changed[i] ? contig->ext_right() :
+                                              prior->ext_right();
+
+            delete contig;
+            contig = new Contig(contig_seqs[i], left, right);
+            contig->set_id(contig_ids[i]);
+        }
+
+        cout << "[EXTENDER] Extended contig [" << i + 1 << "/"
+            << contigs_size << "]: " << contig_ids[i] << endl;
         cout << "\tLeft extension: " << contig->total_ext_left() << " BP"
             << endl;
         cout << "\tRight extension: " << contig->total_ext_right() << " BP"
@@ -288,12 +758,183 @@ int main(int argc, char **argv) {
         cout << "\tExtended contig length: " << contig->total_len() << " BP"
             << endl;
 
-        // store extended contig
-        contigs.emplace_back(contig);
-        contig->set_id(contig_ids[i]);
+        if (!use_POA_consensus) {
+            uint32_t aligner_rounds = 0;
+            double aligner_seconds = 0;
+
+            for (auto const& round : round_stats[task]) {
+                aligner_rounds += round.aligner_seconds > 0;
+                aligner_seconds += round.aligner_seconds;
+            }
+
+            cout << "\tRealignment rounds: " << round_stats[task].size()
+                << ", " << aligner_rounds << " with aligner ("
+                << aligner_seconds << " s)" << endl;
+        }
+
+        contigs.emplace_back(i, contig);
+    }
+
+    if (reuse_extensions) {
+        for (auto& prior : prior_contigs) {
+            if (is_selected[prior.first]) {
+                delete prior.second;
+            } else {
+                contigs.emplace_back(prior);
+            }
+        }
+
+        std::sort(contigs.begin(), contigs.end(),
+            [] (const IndexedContig& a, const IndexedContig& b) {
+                return a.first < b.first;
+            });
+
+        cout << "[INCREMENTAL] Reused " << contigs_size - num_tasks
+            << " extended contigs" << endl;
+    }
+
+    if (use_incremental) {
+        string state_file = string(output_base) + STATE_CONTIGS_FILE;
+
+        cout << "[INCREMENTAL] Writing state to file: " << state_file << endl;
+        shard::write_shard(state_file.c_str(), 0, 1, contigs);
+        incremental::save_batches(output_base, state_keys, batches);
+    }
+
+    if (!use_POA_consensus) {
+        auto stats = scaffolder::get_realign_stats();
+
+        cout << "[EXTENDER] Reads resynchronised in process: "
+            << stats.lookahead_reads << " by lookahead, "
+            << stats.recovered_reads << " by recovery" << endl;
+        cout << "[EXTENDER] External realignment rounds saved: "
+            << stats.saved_rounds << endl;
+        cout << "[EXTENDER] Realignment rounds: " << stats.rounds << ", "
+            << stats.aligner_rounds << " with aligner ("
+            << stats.aligner_seconds << " s), " << stats.policy_stops
+            << " contigs stopped by the gain rate policy" << endl;
+    }
+}
+
+
+string get_executable_path(char *argv0) {
+    char path[PATH_MAX];
+    ssize_t len = readlink("/proc/self/exe", path, PATH_MAX - 1);
+
+    if (len > 0) {
+        return string(path, len);
+    }
+
+    // no procfs, resolve the path the binary was invoked with
+    if (strchr(argv0, '/') != nullptr) {
+        return utility::absolute_path(argv0);
+    }
+
+    return string(argv0);
+}
+
+
+void run_local_shards(int argc, char **argv) {
+    string executable = get_executable_path(argv[0]);
+    uint32_t threads = std::max(1u,
+        utility::get_concurrency_level() / local_shards);
+
+    // forward all options except the local shards option
+    string options;
+    for (int i = 1; i < first_argument_idx && i < argc; ++i) {
+        string arg(argv[i]);
+
+        if (arg == "-N") {
+            ++i;
+            continue;
+        } else if (arg.compare(0, 2, "-N") == 0) {
+            continue;
+        }
+
+        options += " \"" + arg + "\"";
+    }
+
+    string draft = utility::absolute_path(draft_genome_filename);
+    string reads = utility::absolute_path(reads_filename);
+    string output = utility::absolute_path(output_argument);
+    string tmp_dir = utility::absolute_path(tmp_dirname);
+
+    vector<std::thread> workers;
+    vector<char> failed(local_shards, false);
+
+    for (uint32_t i = 0; i < local_shards; ++i) {
+        // every shard uses its own working directory for temporary files
+        string work_dir = tmp_dir + "/shard_" + std::to_string(i);
+        utility::execute_command("mkdir -p %th", work_dir.c_str());
+
+        string command = "cd \"" + work_dir + "\" && \"" + executable + "\"" +
+            options + utility::create_seq_id(" -t %u -P %u,%u", threads, i,
+                                             local_shards) +
+            " \"" + draft + "\" \"" + reads + "\" \"" + output + "\"" +
+            " > \"" + work_dir + "/shard.log\" 2>&1";
+
+        cout << "[SHARD] Starting shard [" << i + 1 << "/" << local_shards
+            << "], log: " << work_dir << "/shard.log" << endl;
+
+        workers.emplace_back([command, i, &failed] {
+            try {
+                utility::execute_command("%s", command.c_str());
+            } catch (std::runtime_error const&) {
+                failed[i] = true;
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (uint32_t i = 0; i < local_shards; ++i) {
+        if (failed[i]) {
+            utility::exit_with_message("Shard %u failed, see %s/shard_%u/"
+                                       "shard.log", i + 1, tmp_dir.c_str(), i);
+        }
+    }
+}
+
+
+void load_shards(uint32_t shards, vector<IndexedContig>* pcontigs) {
+    auto& contigs = *pcontigs;
+
+    for (uint32_t i = 0; i < shards; ++i) {
+        string filename = get_shard_filename(i);
+
+        cout << "[SHARD] Loading shard [" << i + 1 << "/" << shards << "]: "
+            << filename << endl;
+
+        shard::read_shard(filename.c_str(), shards, &contigs);
+    }
+
+    // restore the draft genome order
+    std::sort(contigs.begin(), contigs.end(),
+        [] (const IndexedContig& a, const IndexedContig& b) {
+            return a.first < b.first;
+        });
+
+    for (uint32_t i = 0; i < contigs.size(); ++i) {
+        if (contigs[i].first != i) {
+            utility::exit_with_message("Shards do not cover the draft genome");
+        }
+    }
+}
+
+
+void connect_contigs(const vector<Contig*>& contigs) {
+    StringSet<CharString> contig_ids;
+    StringSet<Dna5String> result_contig_seqs;
+    StringSet<Dna5String> extensions;
+    StringSet<CharString> ext_ids;
+
+    // store extended contigs before the connector changes their orientation
+    for (auto contig : contigs) {
+        appendValue(contig_ids, contig->id());
         appendValue(result_contig_seqs, contig->seq());
 
-        // store extensions
         appendValue(ext_ids, contig->left_id());
         appendValue(extensions, contig->ext_left());
 
@@ -305,7 +946,9 @@ int main(int argc, char **argv) {
 
     // attempt to cennect extended contigs
     Connector connector(contigs);
-    connector.connect_contigs(trim_circular_genome);
+    connector.set_read_links(&read_links);
+    connector.connect_contigs(trim_circular_genome, use_overlap_graph,
+                              use_end_index);
 
     // write all output files
     cout << "[OUTPUT] Writing extended contigs to file: " << contigs_filename
@@ -319,10 +962,58 @@ int main(int argc, char **argv) {
     cout << "[OUTPUT] Writing scaffolds to file: " << scaffolds_filename
         << endl;
     connector.dump_scaffolds(scaffolds_filename);
+}
+
+
+int main(int argc, char **argv) {
+    setup_cmd_interface(argc, argv);
+
+    if (reads_filename == nullptr || draft_genome_filename == nullptr) {
+        parsero::help(argv[0]);
+        exit(1);
+    }
+
+    if ((shard_idx >= 0) + (local_shards > 0) + (merge_shards > 0) +
+            use_incremental > 1) {
+        utility::exit_with_message("Options -I, -M, -N and -P are exclusive");
+    }
+
+    utility::execute_command("mkdir -p %th", tmp_dirname);
+
+    cout << "[RESOURCES] Thread budget: "
+        << ResourceManager::get_instance().budget() << " threads" << endl;
+
+    vector<IndexedContig> indexed_contigs;
+
+    if (merge_shards > 0) {
+        load_shards(merge_shards, &indexed_contigs);
+        init_aligner();
+    } else if (local_shards > 0) {
+        run_local_shards(argc, argv);
+        load_shards(local_shards, &indexed_contigs);
+        init_aligner();
+    } else {
+        extend_draft_genome(&indexed_contigs);
+    }
+
+    if (shard_idx >= 0) {
+        string filename = get_shard_filename(shard_idx);
+
+        cout << "[OUTPUT] Writing shard to file: " << filename << endl;
+        shard::write_shard(filename.c_str(), shard_idx, num_shards,
+                           indexed_contigs);
+    } else {
+        vector<Contig*> contigs;
+        for (auto& indexed_contig : indexed_contigs) {
+            contigs.emplace_back(indexed_contig.second);
+        }
+
+        connect_contigs(contigs);
+    }
 
     // cleanup contigs
-    for (auto contig : contigs) {
-        delete contig;
+    for (auto& indexed_contig : indexed_contigs) {
+        delete indexed_contig.second;
     }
 
     return 0;
@@ -0,0 +1,112 @@
+/**
+ * @file minimizers.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the minimizer functions.
+ * @details Implementation file for the minimizer functions. K-mers are packed
+ * two bits per base and hashed with an invertible integer hash, so that
+ * k-mers of low complexity do not dominate the minimizers.
+ */
+#include <vector>
+
+#include "minimizers.h"
+#include "base_tables.h"
+
+
+namespace minimizers {
+
+
+// invertible 64 bit integer hash restricted to the given mask
+static inline uint64_t hash64(uint64_t key, uint64_t mask) {
+    key = (~key + (key << 21)) & mask;
+    key = key ^ key >> 24;
+    key = ((key + (key << 3)) + (key << 8)) & mask;
+    key = key ^ key >> 14;
+    key = ((key + (key << 2)) + (key << 4)) & mask;
+    key = key ^ key >> 28;
+    key = (key + (key << 31)) & mask;
+    return key;
+}
+
+
+// two bit code of a base in the order A, C, G, T, 4 for other bases
+static inline uint32_t kmer_code(char base) {
+    switch (bases::encode(base)) {
+        case 0: return 0;  // A
+        case 3: return 1;  // C
+        case 2: return 2;  // G
+        case 1: return 3;  // T
+        default: return 4;
+    }
+}
+
+
+void find_minimizers(const char *seq, uint32_t len, uint32_t k, uint32_t w,
+                     bool canonical, vector<Minimizer> *pminimizers) {
+    auto& result = *pminimizers;
+
+    uint64_t mask = k == 32 ? ~0ULL : (1ULL << (2 * k)) - 1;
+    uint32_t shift = 2 * (k - 1);
+
+    uint64_t forward = 0, reverse = 0;
+    uint32_t valid = 0;
+
+    // hashes of the last w k-mers, indexed by k-mer start modulo w
+    vector<Minimizer> window(w, {~0ULL, 0, false});
+    int64_t last_pos = -1;
+
+    for (uint32_t i = 0; i < len; ++i) {
+        uint32_t code = kmer_code(seq[i]);
+
+        if (code < 4) {
+            forward = ((forward << 2) | code) & mask;
+            reverse = (reverse >> 2) | (static_cast<uint64_t>(3 - code)
+                                        << shift);
+            ++valid;
+        } else {
+            valid = 0;
+        }
+
+        if (i + 1 < k) {
+            continue;
+        }
+
+        uint32_t pos = i + 1 - k;
+        Minimizer& slot = window[pos % w];
+
+        if (valid >= k) {
+            uint64_t forward_hash = hash64(forward, mask);
+            uint64_t reverse_hash = hash64(reverse, mask);
+
+            if (canonical && reverse_hash < forward_hash) {
+                slot = {reverse_hash, pos, true};
+            } else {
+                slot = {forward_hash, pos, false};
+            }
+        } else {
+            slot = {~0ULL, pos, false};
+        }
+
+        if (pos + 1 < w) {
+            continue;
+        }
+
+        // leftmost k-mer with the smallest hash in the window
+        const Minimizer *best = nullptr;
+        for (uint32_t j = pos + 1 - w; j <= pos; ++j) {
+            const Minimizer& candidate = window[j % w];
+            if (best == nullptr || candidate.hash < best->hash) {
+                best = &candidate;
+            }
+        }
+
+        if (best->hash != ~0ULL && best->pos != last_pos) {
+            result.push_back(*best);
+            last_pos = best->pos;
+        }
+    }
+}
+
+
+}  // namespace minimizers
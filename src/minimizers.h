@@ -0,0 +1,82 @@
+/**
+ * @file minimizers.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the minimizer functions.
+ * @details Header file for the minimizer functions. A (w, k) minimizer is the
+ * k-mer with the smallest hash among w consecutive k-mers of a sequence.
+ * Sequences sharing a long enough substring share the minimizers of that
+ * substring, which makes minimizers a compact seed for overlap detection.
+ */
+#ifndef MINIMIZERS_H
+#define MINIMIZERS_H
+
+#include <vector>
+#include <cstdint>
+
+
+using std::vector;
+
+
+/**
+ * @brief Default k-mer length of the minimizers
+ */
+#define MINIMIZER_K 15
+
+/**
+ * @brief Default number of consecutive k-mers a minimizer is selected from
+ */
+#define MINIMIZER_W 10
+
+
+/**
+ * @brief Namespace for minimizer functions
+ */
+namespace minimizers {
+
+
+/**
+ * @brief A minimizer of a sequence.
+ */
+struct Minimizer {
+    /**
+     * @brief hash of the k-mer
+     */
+    uint64_t hash;
+
+    /**
+     * @brief position of the first base of the k-mer in the sequence
+     */
+    uint32_t pos;
+
+    /**
+     * @brief true if the minimizer is the reverse complement of the k-mer
+     */
+    bool reverse;
+};
+
+
+/**
+ * @brief Computes the minimizers of a sequence.
+ * @details K-mers containing bases other than A, C, G and T are skipped. With
+ * canonical set, each k-mer is represented by the smaller hash of its two
+ * strands, so that a sequence and its reverse complement have the same
+ * minimizers. A k-mer selected by several consecutive windows is reported
+ * once. Minimizers are appended in increasing position order.
+ *
+ * @param seq sequence bases
+ * @param len number of bases
+ * @param k k-mer length, at most 32
+ * @param w number of consecutive k-mers per window
+ * @param canonical true to use canonical k-mers
+ * @param pminimizers pointer to the output vector
+ */
+void find_minimizers(const char *seq, uint32_t len, uint32_t k, uint32_t w,
+                     bool canonical, vector<Minimizer> *pminimizers);
+
+
+}  // namespace minimizers
+
+
+#endif  // MINIMIZERS_H
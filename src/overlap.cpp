@@ -0,0 +1,135 @@
+/**
+ * @file overlap.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the in process end overlap detection.
+ * @details Implementation file for the in process end overlap detection.
+ */
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "overlap.h"
+#include "minimizers.h"
+#include "edit_distance.h"
+
+
+using std::string;
+using std::vector;
+using std::pair;
+
+
+namespace overlap {
+
+
+bool verify_end_overlap(const SequenceSlice& query,
+                        const SequenceSlice& target,
+                        uint32_t target_begin,
+                        EndOverlap *poverlap) {
+    uint32_t query_len = query.end - query.begin;
+    uint32_t target_len = target.end - target.begin;
+    if (target_begin >= target_len) {
+        return false;
+    }
+
+    uint32_t suffix_len = target_len - target_begin;
+    uint32_t max_distance = OVERLAP_ERROR_RATE * suffix_len;
+
+    // the aligned query prefix is at most max_distance longer than the suffix
+    uint32_t prefix_len = std::min(query_len, suffix_len + max_distance);
+
+    string suffix = utility::slice_to_string(target, target_begin,
+                                             target_len);
+    string prefix = utility::slice_to_string(query, 0, prefix_len);
+
+    // the minimizer chain fixes the diagonal, the alignment can only drift
+    // from it by the band of the chain
+    edit_distance::PrefixAlignment alignment;
+    if (!edit_distance::align_prefix_banded(suffix.data(), suffix_len,
+                                            prefix.data(), prefix_len,
+                                            max_distance,
+                                            OVERLAP_DIAGONAL_BAND,
+                                            &alignment)) {
+        return false;
+    }
+
+    poverlap->target_begin = target_begin;
+    poverlap->query_end = alignment.text_end;
+    poverlap->distance = alignment.distance;
+    return true;
+}
+
+
+bool find_end_overlap(const SequenceSlice& query,
+                      const SequenceSlice& target,
+                      EndOverlap *poverlap) {
+    uint32_t query_len = query.end - query.begin;
+    uint32_t target_len = target.end - target.begin;
+    uint32_t tail_begin = target_len > query_len ? target_len - query_len : 0;
+
+    string query_seq = utility::slice_to_string(query, 0, query_len);
+    string tail_seq = utility::slice_to_string(target, tail_begin,
+                                               target_len);
+
+    vector<minimizers::Minimizer> query_mins, tail_mins;
+    minimizers::find_minimizers(query_seq.data(), query_seq.length(),
+                                MINIMIZER_K, MINIMIZER_W, false, &query_mins);
+    minimizers::find_minimizers(tail_seq.data(), tail_seq.length(),
+                                MINIMIZER_K, MINIMIZER_W, false, &tail_mins);
+
+    auto by_hash = [](const minimizers::Minimizer& a,
+                      const minimizers::Minimizer& b) {
+        return a.hash < b.hash;
+    };
+    std::sort(tail_mins.begin(), tail_mins.end(), by_hash);
+
+    // (diagonal, query position) of every shared minimizer
+    vector<pair<int64_t, uint32_t>> hits;
+    for (auto const& minimizer : query_mins) {
+        auto range = std::equal_range(tail_mins.begin(), tail_mins.end(),
+                                      minimizer, by_hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            int64_t diagonal = static_cast<int64_t>(it->pos) + tail_begin -
+                               minimizer.pos;
+            hits.push_back({diagonal, minimizer.pos});
+        }
+    }
+
+    std::sort(hits.begin(), hits.end());
+
+    // densest group of hits within the diagonal band
+    uint32_t best_begin = 0, best_count = 0;
+    for (uint32_t i = 0, j = 0; j < hits.size(); ++j) {
+        while (hits[j].first - hits[i].first > OVERLAP_DIAGONAL_BAND) {
+            ++i;
+        }
+        if (j - i + 1 > best_count) {
+            best_count = j - i + 1;
+            best_begin = i;
+        }
+    }
+
+    if (best_count < OVERLAP_MIN_HITS) {
+        return false;
+    }
+
+    // the hit closest to the query start locates the overlap start
+    auto first = std::min_element(hits.begin() + best_begin,
+        hits.begin() + best_begin + best_count,
+        [](const pair<int64_t, uint32_t>& a,
+           const pair<int64_t, uint32_t>& b) {
+            return a.second < b.second;
+        });
+
+    int64_t target_begin = std::max<int64_t>(first->first, 0);
+    if (target_begin >= target_len) {
+        return false;
+    }
+
+    return verify_end_overlap(query, target, target_begin, poverlap);
+}
+
+
+}  // namespace overlap
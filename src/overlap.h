@@ -0,0 +1,105 @@
+/**
+ * @file overlap.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the in process end overlap detection.
+ * @details Header file for the in process end overlap detection. Overlaps of
+ * a query prefix with a target suffix are seeded with shared minimizers and
+ * verified with a banded bit-parallel edit distance, which replaces a round
+ * trip through the external aligner for single overlap checks.
+ */
+#ifndef OVERLAP_H
+#define OVERLAP_H
+
+#include <cstdint>
+
+#include "utility.h"
+
+
+/**
+ * @brief Width in bases of the diagonal band of a minimizer chain
+ */
+#define OVERLAP_DIAGONAL_BAND 100
+
+/**
+ * @brief Minimum number of shared minimizers of an overlap
+ */
+#define OVERLAP_MIN_HITS 4
+
+/**
+ * @brief Maximum edit distance per overlap base
+ */
+#define OVERLAP_ERROR_RATE 0.3
+
+
+/**
+ * @brief Namespace for overlap detection functions
+ */
+namespace overlap {
+
+
+/**
+ * @brief Overlap of a query prefix with a target suffix.
+ */
+struct EndOverlap {
+    /**
+     * @brief position of the target where the overlap begins
+     */
+    uint32_t target_begin;
+
+    /**
+     * @brief number of query bases aligned to the target suffix
+     */
+    uint32_t query_end;
+
+    /**
+     * @brief edit distance of the overlap
+     */
+    uint32_t distance;
+};
+
+
+/**
+ * @brief Verifies an overlap of a query prefix with a target suffix.
+ * @details The target suffix starting at target_begin is aligned to a query
+ * prefix within OVERLAP_DIAGONAL_BAND of the diagonal through target_begin,
+ * the overlap is accepted if the edit distance is within OVERLAP_ERROR_RATE
+ * of the suffix length.
+ *
+ * @param query query sequence, e.g. a contig anchor
+ * @param target target sequence, e.g. a contig
+ * @param target_begin position of the target where the overlap begins
+ * @param poverlap pointer to the output overlap
+ *
+ * @return True if the overlap was verified, false otherwise.
+ */
+bool verify_end_overlap(const SequenceSlice& query,
+                        const SequenceSlice& target,
+                        uint32_t target_begin,
+                        EndOverlap *poverlap);
+
+
+/**
+ * @brief Finds the overlap of a query prefix with the end of a target.
+ * @details Only the last query length bases of the target are searched.
+ * Minimizers shared by the query and the target tail are grouped by
+ * diagonal, the densest group within OVERLAP_DIAGONAL_BAND gives the start
+ * of the overlap in the target, which is then checked with
+ * verify_end_overlap.
+ *
+ * @param query query sequence, e.g. a contig anchor
+ * @param target target sequence, e.g. a contig
+ * @param poverlap pointer to the output overlap
+ *
+ * @return True if an overlap was found, false otherwise.
+ */
+bool find_end_overlap(const SequenceSlice& query,
+                      const SequenceSlice& target,
+                      EndOverlap *poverlap);
+
+
+}  // namespace overlap
+
+
+#endif  // OVERLAP_H
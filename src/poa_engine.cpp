@@ -0,0 +1,160 @@
+/**
+ * @file poa_engine.cpp
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the PoaEngine class.
+ * @details Implementation file for the PoaEngine class. The engine collects
+ * the POA consensus jobs of all contig ends and computes them in parallel.
+ */
+#include <cpppoa/poa.hpp>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <utility>
+
+#include "poa_engine.h"
+#include "thread_pool.h"
+#include "resources.h"
+#include "windows.h"
+#include "utility.h"
+
+
+using std::vector;
+using std::string;
+using std::sort;
+using std::pair;
+
+
+poa_backend::PoaBackend poa_backend::string_to_poa_backend(
+        const char *backend) {
+    string s_backend(backend);
+
+    if (s_backend == "cpppoa") {
+        return CppPoa;
+    } else if (s_backend == "native") {
+        return Native;
+    } else {
+        utility::exit_with_message("Unknown POA engine.");
+        // silence compiler warning for no return value
+        return CppPoa;
+    }
+}
+
+
+PoaEngine::PoaEngine(uint32_t num_threads, uint32_t window_len,
+                     poa_backend::PoaBackend backend):
+    num_threads_(num_threads), window_len_(window_len), backend_(backend) {}
+
+
+void PoaEngine::add_job(const ContigEnd& end, vector<string>&& sequences) {
+    uint64_t total_len = 0;
+    for (auto const& seq : sequences) {
+        total_len += seq.length();
+    }
+
+    jobs_.push_back({end, std::move(sequences), total_len, {}, {}});
+}
+
+
+bool PoaEngine::is_windowed(const Job& job) const {
+    if (window_len_ == 0) {
+        return false;
+    }
+
+    uint32_t max_len = window_len_ + windows::window_overlap(window_len_);
+    for (auto const& seq : job.sequences) {
+        if (seq.length() > max_len) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+ConsensusMap PoaEngine::run() {
+    // schedule the most expensive jobs first
+    sort(jobs_.begin(), jobs_.end(), [](const Job& a, const Job& b) {
+        return a.total_len > b.total_len;
+    });
+
+    {
+        ThreadLease lease(WORKER_THREADS, num_threads_);
+        ThreadPool pool(lease.threads());
+        // one native kernel per worker, reused for all its windows
+        vector<NativePoa> kernels(pool.size());
+
+        // split long jobs into windows, every job writes only its own slot
+        for (size_t i = 0; i < jobs_.size(); ++i) {
+            pool.submit([this, i] (uint32_t worker_id) {
+                (void) worker_id;
+                Job& job = jobs_[i];
+
+                if (is_windowed(job)) {
+                    job.windows = windows::split_windows(job.sequences,
+                                                         window_len_);
+                }
+
+                // without a covered first window the unsplit sequences
+                // still give a consensus
+                if (job.windows.empty()) {
+                    job.windows.emplace_back(std::move(job.sequences));
+                }
+
+                job.sequences.clear();
+                job.consensus.resize(job.windows.size());
+            });
+        }
+
+        pool.wait();
+
+        // compute the consensus of all windows, most expensive first
+        vector<pair<uint64_t, pair<uint32_t, uint32_t>>> tasks;
+        for (uint32_t i = 0; i < jobs_.size(); ++i) {
+            for (uint32_t k = 0; k < jobs_[i].windows.size(); ++k) {
+                uint64_t window_len = 0;
+                for (auto const& seq : jobs_[i].windows[k]) {
+                    window_len += seq.length();
+                }
+                tasks.push_back({window_len, {i, k}});
+            }
+        }
+
+        sort(tasks.begin(), tasks.end(), [](
+                const pair<uint64_t, pair<uint32_t, uint32_t>>& a,
+                const pair<uint64_t, pair<uint32_t, uint32_t>>& b) {
+            return a.first > b.first;
+        });
+
+        for (auto const& task : tasks) {
+            uint32_t i = task.second.first;
+            uint32_t k = task.second.second;
+
+            pool.submit([this, i, k, &kernels] (uint32_t worker_id) {
+                auto const& window = jobs_[i].windows[k];
+
+                if (backend_ == poa_backend::Native) {
+                    jobs_[i].consensus[k] =
+                        kernels[worker_id].consensus(window);
+                } else {
+                    jobs_[i].consensus[k] = poa_consensus(window);
+                }
+            });
+        }
+
+        pool.wait();
+    }
+
+    ConsensusMap consensus;
+    for (auto& job : jobs_) {
+        if (job.consensus.size() == 1) {
+            consensus[job.end] = std::move(job.consensus[0]);
+        } else {
+            consensus[job.end] = windows::stitch_windows(job.consensus,
+                                                         window_len_);
+        }
+    }
+
+    jobs_.clear();
+    return consensus;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file poa_engine.h
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the PoaEngine class.
+ * @details Header file for the PoaEngine class. The engine collects the POA
+ * consensus jobs of all contig ends and computes them in parallel.
+ */
+#ifndef POA_ENGINE_H
+#define POA_ENGINE_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "contig.h"
+#include "poa_kernel.h"
+
+
+using std::vector;
+using std::string;
+using std::unordered_map;
+
+
+/**
+ * @brief Consensus sequences keyed by the contig end they extend.
+ */
+typedef unordered_map<ContigEnd, string, ContigEndHash> ConsensusMap;
+
+
+namespace poa_backend {
+
+/**
+ * @brief Enum used to distinguish POA consensus implementations.
+ */
+enum PoaBackend {
+    CppPoa,
+    Native
+};
+
+
+/**
+ * @brief Converts the given string to a PoaBackend enumerator object
+ *
+ * @param backend C-style string ID of the backend
+ * @return the enum associated to the passed string
+ */
+PoaBackend string_to_poa_backend(const char *backend);
+
+}  // namespace poa_backend
+
+
+/**
+ * @brief Batched POA consensus engine.
+ * @details Every contig end that should be extended with the POA method is
+ * registered as a job holding the extension sequences of the reads spanning
+ * that end. All jobs are then executed at once on a pool of worker threads,
+ * longest jobs first, so that a few deep contig ends do not serialize the
+ * tail of the run. When a window length is set, jobs with sequences longer
+ * than a window are split into overlapping windows, the window consensus
+ * sequences are computed in parallel with all other work and stitched back
+ * together. Jobs whose first window is not covered by enough reads fall
+ * back to the consensus of the unsplit sequences. The consensus is computed
+ * either by cpppoa or by the native banded kernel, in which case every
+ * worker thread keeps its own kernel so that the graph arena is reused
+ * across the windows it processes.
+ */
+class PoaEngine {
+ public:
+    /**
+     * @brief PoaEngine class constructor.
+     *
+     * @param num_threads number of worker threads used by the run method
+     * @param window_len window length in bases, 0 disables windowing
+     * @param backend POA implementation used to compute the consensus
+     */
+    explicit PoaEngine(uint32_t num_threads, uint32_t window_len = 0,
+                       poa_backend::PoaBackend backend = poa_backend::CppPoa);
+
+
+    /**
+     * @brief Registers a consensus job.
+     *
+     * @param end contig end extended by the consensus
+     * @param sequences extension sequences, ownership is taken by the engine
+     */
+    void add_job(const ContigEnd& end, vector<string>&& sequences);
+
+
+    /**
+     * @brief Getter for the number of registered jobs.
+     * @return Number of registered jobs.
+     */
+    uint32_t num_jobs() const { return jobs_.size(); }
+
+
+    /**
+     * @brief Computes the consensus for every registered job.
+     * @details Jobs are consumed by the call, the engine can afterwards be
+     * reused for a new batch.
+     *
+     * @return consensus sequences keyed by contig end
+     */
+    ConsensusMap run();
+
+ private:
+    /**
+     * @brief Single consensus job.
+     */
+    struct Job {
+        ContigEnd end;
+        vector<string> sequences;
+        uint64_t total_len;
+        // read segments of each window, a single window if not windowed
+        vector<vector<string>> windows;
+        // consensus of each window
+        vector<string> consensus;
+    };
+
+    /**
+     * @brief Returns true if the sequences of the job should be windowed.
+     */
+    bool is_windowed(const Job& job) const;
+
+    // number of worker threads
+    uint32_t num_threads_;
+    // window length, 0 if windowing is disabled
+    uint32_t window_len_;
+    // POA implementation
+    poa_backend::PoaBackend backend_;
+    // registered jobs
+    vector<Job> jobs_;
+};
+
+
+#endif  // POA_ENGINE_H
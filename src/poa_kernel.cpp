@@ -0,0 +1,551 @@
+/**
+ * @file poa_kernel.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the native partial order alignment kernel.
+ * @details Implementation file for the native partial order alignment kernel.
+ * The score of a node row is the maximum over its predecessor rows of the
+ * diagonal and vertical moves, which are computed with vector instructions on
+ * the band shared by the two rows, followed by a scalar pass for the
+ * horizontal moves.
+ */
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <string>
+
+#include "poa_kernel.h"
+#include "base_tables.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define POA_KERNEL_X86
+#endif
+
+
+/**
+ * @brief Score of two equal bases
+ */
+#define POA_MATCH 5
+
+/**
+ * @brief Score of two different bases, N never matches
+ */
+#define POA_MISMATCH -4
+
+/**
+ * @brief Score of an insertion or deletion of a single base
+ */
+#define POA_GAP -8
+
+/**
+ * @brief Score of the cells outside of the band, low enough to never overflow
+ */
+#define POA_NEG_INF (std::numeric_limits<int32_t>::min() / 4)
+
+/**
+ * @brief Node index of the virtual start row and of missing alignment parts
+ */
+#define NONE std::numeric_limits<uint32_t>::max()
+
+
+namespace {
+
+
+// dst[i] = max(dst[i], src[i] + add[i]) for i < size
+typedef void (*max_add_function)(int32_t*, const int32_t*, const int32_t*,
+                                 uint32_t);
+
+// dst[i] = max(dst[i], src[i] + value) for i < size
+typedef void (*max_add_scalar_function)(int32_t*, const int32_t*, int32_t,
+                                        uint32_t);
+
+
+void max_add_scalar(int32_t *dst, const int32_t *src, const int32_t *add,
+                    uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i) {
+        dst[i] = std::max(dst[i], src[i] + add[i]);
+    }
+}
+
+
+void max_add_value_scalar(int32_t *dst, const int32_t *src, int32_t value,
+                          uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i) {
+        dst[i] = std::max(dst[i], src[i] + value);
+    }
+}
+
+
+#ifdef POA_KERNEL_X86
+
+__attribute__((target("sse4.1")))
+void max_add_sse41(int32_t *dst, const int32_t *src, const int32_t *add,
+                   uint32_t size) {
+    uint32_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*) (dst + i));
+        __m128i s = _mm_loadu_si128((const __m128i*) (src + i));
+        __m128i a = _mm_loadu_si128((const __m128i*) (add + i));
+        d = _mm_max_epi32(d, _mm_add_epi32(s, a));
+        _mm_storeu_si128((__m128i*) (dst + i), d);
+    }
+
+    max_add_scalar(dst + i, src + i, add + i, size - i);
+}
+
+
+__attribute__((target("sse4.1")))
+void max_add_value_sse41(int32_t *dst, const int32_t *src, int32_t value,
+                         uint32_t size) {
+    __m128i v = _mm_set1_epi32(value);
+
+    uint32_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*) (dst + i));
+        __m128i s = _mm_loadu_si128((const __m128i*) (src + i));
+        d = _mm_max_epi32(d, _mm_add_epi32(s, v));
+        _mm_storeu_si128((__m128i*) (dst + i), d);
+    }
+
+    max_add_value_scalar(dst + i, src + i, value, size - i);
+}
+
+
+__attribute__((target("avx2")))
+void max_add_avx2(int32_t *dst, const int32_t *src, const int32_t *add,
+                  uint32_t size) {
+    uint32_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i d = _mm256_loadu_si256((const __m256i*) (dst + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*) (src + i));
+        __m256i a = _mm256_loadu_si256((const __m256i*) (add + i));
+        d = _mm256_max_epi32(d, _mm256_add_epi32(s, a));
+        _mm256_storeu_si256((__m256i*) (dst + i), d);
+    }
+
+    max_add_scalar(dst + i, src + i, add + i, size - i);
+}
+
+
+__attribute__((target("avx2")))
+void max_add_value_avx2(int32_t *dst, const int32_t *src, int32_t value,
+                        uint32_t size) {
+    __m256i v = _mm256_set1_epi32(value);
+
+    uint32_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i d = _mm256_loadu_si256((const __m256i*) (dst + i));
+        __m256i s = _mm256_loadu_si256((const __m256i*) (src + i));
+        d = _mm256_max_epi32(d, _mm256_add_epi32(s, v));
+        _mm256_storeu_si256((__m256i*) (dst + i), d);
+    }
+
+    max_add_value_scalar(dst + i, src + i, value, size - i);
+}
+
+#endif  // POA_KERNEL_X86
+
+
+struct KernelSelection {
+    max_add_function max_add;
+    max_add_scalar_function max_add_value;
+    const char *name;
+
+    KernelSelection(): max_add(max_add_scalar),
+                       max_add_value(max_add_value_scalar), name("scalar") {
+#ifdef POA_KERNEL_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2")) {
+            max_add = max_add_avx2;
+            max_add_value = max_add_value_avx2;
+            name = "avx2";
+        } else if (__builtin_cpu_supports("sse4.1")) {
+            max_add = max_add_sse41;
+            max_add_value = max_add_value_sse41;
+            name = "sse4.1";
+        }
+#endif
+    }
+};
+
+
+const KernelSelection& get_kernel() {
+    static const KernelSelection selection;
+    return selection;
+}
+
+
+}  // namespace
+
+
+NativePoa::NativePoa(uint32_t band_width): band_width_(band_width),
+                                            num_nodes_(0), seq_len_(0) {}
+
+
+void NativePoa::reset() {
+    num_nodes_ = 0;
+    order_.clear();
+}
+
+
+uint32_t NativePoa::add_node(char base) {
+    uint32_t node = num_nodes_++;
+
+    if (node < bases_.size()) {
+        // reuse the slot of a previous graph
+        bases_[node] = base;
+        in_nodes_[node].clear();
+        out_edges_[node].clear();
+        aligned_nodes_[node].clear();
+    } else {
+        bases_.push_back(base);
+        in_nodes_.emplace_back();
+        out_edges_.emplace_back();
+        aligned_nodes_.emplace_back();
+    }
+
+    return node;
+}
+
+
+void NativePoa::add_edge(uint32_t source, uint32_t target) {
+    for (auto& edge : out_edges_[source]) {
+        if (edge.target == target) {
+            edge.weight++;
+            return;
+        }
+    }
+
+    out_edges_[source].push_back({target, 1});
+    in_nodes_[target].push_back(source);
+}
+
+
+void NativePoa::topological_sort() {
+    // Kahn's algorithm, min_distance_ is used as the in degree buffer
+    order_.clear();
+    min_distance_.assign(num_nodes_, 0);
+
+    for (uint32_t node = 0; node < num_nodes_; ++node) {
+        min_distance_[node] = in_nodes_[node].size();
+        if (min_distance_[node] == 0) {
+            order_.push_back(node);
+        }
+    }
+
+    for (uint32_t i = 0; i < order_.size(); ++i) {
+        for (auto const& edge : out_edges_[order_[i]]) {
+            if (--min_distance_[edge.target] == 0) {
+                order_.push_back(edge.target);
+            }
+        }
+    }
+}
+
+
+int32_t NativePoa::cell(uint32_t node, uint32_t position) const {
+    if (node == NONE) {
+        return position * POA_GAP;
+    }
+
+    if (position < band_begin_[node] || position > band_end_[node]) {
+        return POA_NEG_INF;
+    }
+
+    return scores_[row_offsets_[node] + position - band_begin_[node]];
+}
+
+
+void NativePoa::align(const string& seq, vector<AlignedPair>* palignment) {
+    auto const& kernel = get_kernel();
+    auto& alignment = *palignment;
+
+    seq_len_ = seq.length();
+    uint32_t row_len = seq_len_ + 1;
+
+    // score of each node base against each sequence position
+    profile_.resize(NUM_BASE_CODES * row_len);
+    for (int code = 0; code < NUM_BASE_CODES; ++code) {
+        int32_t *row = profile_.data() + code * row_len;
+        row[0] = POA_NEG_INF;
+        for (uint32_t j = 1; j < row_len; ++j) {
+            bool match = code != BASE_N_IDX &&
+                         bases::encode(seq[j - 1]) == code;
+            row[j] = match ? POA_MATCH : POA_MISMATCH;
+        }
+    }
+
+    start_row_.resize(row_len);
+    for (uint32_t j = 0; j < row_len; ++j) {
+        start_row_[j] = j * POA_GAP;
+    }
+
+    min_distance_.resize(num_nodes_);
+    max_distance_.resize(num_nodes_);
+    band_begin_.resize(num_nodes_);
+    band_end_.resize(num_nodes_);
+    row_offsets_.resize(num_nodes_);
+    scores_.clear();
+
+    uint32_t best_node = NONE;
+    uint32_t best_position = 0;
+    int32_t best_score = POA_NEG_INF;
+
+    for (uint32_t node : order_) {
+        auto const& preds = in_nodes_[node];
+
+        // distance range of the node from the start of the graph
+        uint32_t min_dist = 1, max_dist = 1;
+        if (!preds.empty()) {
+            min_dist = NONE;
+            max_dist = 0;
+            for (uint32_t pred : preds) {
+                min_dist = std::min(min_dist, min_distance_[pred] + 1);
+                max_dist = std::max(max_dist, max_distance_[pred] + 1);
+            }
+        }
+
+        min_distance_[node] = min_dist;
+        max_distance_[node] = max_dist;
+
+        uint32_t begin = min_dist > band_width_ ? min_dist - band_width_ : 0;
+        uint32_t end = std::min(seq_len_, max_dist + band_width_);
+        begin = std::min(begin, end);
+
+        band_begin_[node] = begin;
+        band_end_[node] = end;
+        row_offsets_[node] = scores_.size();
+        scores_.resize(scores_.size() + end - begin + 1, POA_NEG_INF);
+
+        int32_t *row = scores_.data() + row_offsets_[node];
+        const int32_t *profile = profile_.data() +
+                                 bases::encode(bases_[node]) * row_len;
+
+        auto relax = [&](const int32_t *pred_row, uint32_t pred_begin,
+                         uint32_t pred_end) {
+            // vertical move, the node is deleted from the sequence
+            uint32_t from = std::max(begin, pred_begin);
+            uint32_t to = std::min(end, pred_end);
+            if (from <= to) {
+                kernel.max_add_value(row + from - begin,
+                                     pred_row + from - pred_begin,
+                                     POA_GAP, to - from + 1);
+            }
+
+            // diagonal move, the node is aligned to a sequence base
+            from = std::max(std::max(begin, pred_begin + 1), 1u);
+            to = std::min(end, pred_end + 1);
+            if (from <= to) {
+                kernel.max_add(row + from - begin,
+                               pred_row + from - 1 - pred_begin,
+                               profile + from, to - from + 1);
+            }
+        };
+
+        if (preds.empty()) {
+            relax(start_row_.data(), 0, seq_len_);
+        } else {
+            for (uint32_t pred : preds) {
+                relax(scores_.data() + row_offsets_[pred], band_begin_[pred],
+                      band_end_[pred]);
+            }
+        }
+
+        // horizontal move, a sequence base is inserted after the node
+        for (uint32_t j = 1; j <= end - begin; ++j) {
+            row[j] = std::max(row[j], row[j - 1] + POA_GAP);
+        }
+
+        // the sequence may end anywhere in the graph, the graph may end
+        // anywhere in the sequence
+        if (end == seq_len_ && row[end - begin] > best_score) {
+            best_node = node;
+            best_position = seq_len_;
+            best_score = row[end - begin];
+        }
+
+        if (out_edges_[node].empty()) {
+            for (uint32_t j = begin; j <= end; ++j) {
+                if (row[j - begin] > best_score) {
+                    best_node = node;
+                    best_position = j;
+                    best_score = row[j - begin];
+                }
+            }
+        }
+    }
+
+    // traceback, the alignment is built in reverse
+    alignment.clear();
+    for (uint32_t j = seq_len_; j > best_position; --j) {
+        alignment.push_back({NONE, j - 1});
+    }
+
+    uint32_t node = best_node;
+    uint32_t j = best_position;
+
+    while (node != NONE) {
+        int32_t score = cell(node, j);
+        const int32_t *profile = profile_.data() +
+                                 bases::encode(bases_[node]) * row_len;
+
+        auto const& preds = in_nodes_[node];
+        uint32_t num_preds = std::max<uint32_t>(preds.size(), 1);
+        bool moved = false;
+
+        for (uint32_t k = 0; k < num_preds && j > 0 && !moved; ++k) {
+            uint32_t pred = preds.empty() ? NONE : preds[k];
+            if (cell(pred, j - 1) + profile[j] == score) {
+                alignment.push_back({node, j - 1});
+                node = pred;
+                --j;
+                moved = true;
+            }
+        }
+
+        for (uint32_t k = 0; k < num_preds && !moved; ++k) {
+            uint32_t pred = preds.empty() ? NONE : preds[k];
+            if (cell(pred, j) + POA_GAP == score) {
+                alignment.push_back({node, NONE});
+                node = pred;
+                moved = true;
+            }
+        }
+
+        if (!moved) {
+            alignment.push_back({NONE, j - 1});
+            --j;
+        }
+    }
+
+    for (; j > 0; --j) {
+        alignment.push_back({NONE, j - 1});
+    }
+
+    std::reverse(alignment.begin(), alignment.end());
+}
+
+
+void NativePoa::add_alignment(const string& seq,
+                              const vector<AlignedPair>& alignment) {
+    uint32_t prev = NONE;
+
+    for (auto const& pair : alignment) {
+        if (pair.position == NONE) {
+            continue;
+        }
+
+        char base = seq[pair.position];
+        uint32_t node = pair.node;
+
+        if (node == NONE) {
+            node = add_node(base);
+        } else if (bases_[node] != base) {
+            // reuse a node with the same base aligned to the matched one
+            uint32_t aligned = NONE;
+            for (uint32_t other : aligned_nodes_[node]) {
+                if (bases_[other] == base) {
+                    aligned = other;
+                    break;
+                }
+            }
+
+            if (aligned == NONE) {
+                aligned = add_node(base);
+                for (uint32_t other : aligned_nodes_[node]) {
+                    aligned_nodes_[other].push_back(aligned);
+                    aligned_nodes_[aligned].push_back(other);
+                }
+                aligned_nodes_[node].push_back(aligned);
+                aligned_nodes_[aligned].push_back(node);
+            }
+
+            node = aligned;
+        }
+
+        if (prev != NONE) {
+            add_edge(prev, node);
+        }
+        prev = node;
+    }
+}
+
+
+string NativePoa::heaviest_path(uint32_t num_sequences) const {
+    vector<uint64_t> scores(num_nodes_, 0);
+    vector<uint32_t> best_pred(num_nodes_, NONE);
+    vector<uint32_t> pred_weight(num_nodes_, 0);
+
+    uint32_t end = NONE;
+    for (uint32_t node : order_) {
+        for (auto const& edge : out_edges_[node]) {
+            uint64_t score = scores[node] + edge.weight;
+            uint32_t target = edge.target;
+
+            // on ties prefer the edge supported by more sequences
+            if (score > scores[target] || (score == scores[target] &&
+                    edge.weight > pred_weight[target])) {
+                scores[target] = score;
+                best_pred[target] = node;
+                pred_weight[target] = edge.weight;
+            }
+        }
+
+        if (end == NONE || scores[node] > scores[end]) {
+            end = node;
+        }
+    }
+
+    if (end == NONE) {
+        return "";
+    }
+
+    // drop the tail supported by too few sequences
+    uint32_t min_weight = std::min<uint32_t>(num_sequences,
+                                             POA_MIN_TAIL_WEIGHT);
+    while (best_pred[end] != NONE && pred_weight[end] < min_weight) {
+        end = best_pred[end];
+    }
+
+    string consensus;
+    for (uint32_t node = end; node != NONE; node = best_pred[node]) {
+        consensus.push_back(bases_[node]);
+    }
+
+    std::reverse(consensus.begin(), consensus.end());
+    return consensus;
+}
+
+
+string NativePoa::consensus(const vector<string>& sequences) {
+    reset();
+
+    auto& alignment = alignment_;
+    for (auto const& seq : sequences) {
+        if (seq.empty()) {
+            continue;
+        }
+
+        if (num_nodes_ == 0) {
+            alignment.clear();
+            for (uint32_t j = 0; j < seq.length(); ++j) {
+                alignment.push_back({NONE, j});
+            }
+        } else {
+            align(seq, &alignment);
+        }
+
+        add_alignment(seq, alignment);
+        topological_sort();
+    }
+
+    return heaviest_path(sequences.size());
+}
+
+
+const char *poa_kernel_name() {
+    return get_kernel().name;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file poa_kernel.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the native partial order alignment kernel.
+ * @details Header file for the native partial order alignment kernel. The
+ * kernel builds a partial order graph of the given sequences by banded
+ * alignment of each sequence to the graph and returns the heaviest path
+ * through the graph as the consensus. Graph nodes and alignment scores are
+ * stored in arenas which are reused by consecutive consensus calls.
+ */
+#ifndef POA_KERNEL_H
+#define POA_KERNEL_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+using std::vector;
+using std::string;
+
+
+/**
+ * @brief Default half width of the alignment band in bases
+ */
+#define POA_BAND_WIDTH 64
+
+/**
+ * @brief Minimum number of sequences supporting the end of the consensus
+ */
+#define POA_MIN_TAIL_WEIGHT 2
+
+
+/**
+ * @brief Banded partial order alignment consensus.
+ * @details Sequences are expected to share their start, as extension
+ * sequences of a contig end do, while their ends are free. Each sequence is
+ * aligned to the graph with linear gap scores, the score of a graph node is
+ * computed only for the sequence positions within the band around the
+ * distances of the node from the graph start. Row updates are vectorized with
+ * the widest instruction set supported by the CPU. An instance is not thread
+ * safe, every worker thread should use its own instance.
+ */
+class NativePoa {
+ public:
+    /**
+     * @brief NativePoa class constructor.
+     *
+     * @param band_width half width of the alignment band in bases
+     */
+    explicit NativePoa(uint32_t band_width = POA_BAND_WIDTH);
+
+
+    /**
+     * @brief Computes the consensus of the given sequences.
+     * @details The graph of the previous call is discarded while the memory
+     * of its arenas is kept for this call.
+     *
+     * @param sequences sequences sharing their first base
+     * @return Consensus sequence.
+     */
+    string consensus(const vector<string>& sequences);
+
+
+    /**
+     * @brief Getter for the number of nodes of the last graph.
+     * @return Number of graph nodes.
+     */
+    uint32_t num_nodes() const { return num_nodes_; }
+
+ private:
+    /**
+     * @brief Weighted edge of the graph.
+     */
+    struct Edge {
+        uint32_t target;
+        uint32_t weight;
+    };
+
+    /**
+     * @brief Node and sequence position pair of an alignment, either can be
+     * NONE for insertions and deletions.
+     */
+    struct AlignedPair {
+        uint32_t node;
+        uint32_t position;
+    };
+
+    // discards the graph, keeping the arena memory
+    void reset();
+    // adds a node to the arena
+    uint32_t add_node(char base);
+    // adds or reinforces an edge
+    void add_edge(uint32_t source, uint32_t target);
+    // recomputes the topological order of the nodes
+    void topological_sort();
+    // aligns a sequence to the graph
+    void align(const string& seq, vector<AlignedPair>* palignment);
+    // adds an aligned sequence to the graph
+    void add_alignment(const string& seq,
+                       const vector<AlignedPair>& alignment);
+    // score of a cell, very low if the cell is outside of the band
+    int32_t cell(uint32_t node, uint32_t position) const;
+    // returns the heaviest path through the graph
+    string heaviest_path(uint32_t num_sequences) const;
+
+    uint32_t band_width_;
+
+    // graph arena, slots past num_nodes_ are kept for reuse
+    uint32_t num_nodes_;
+    vector<char> bases_;
+    vector<vector<uint32_t>> in_nodes_;
+    vector<vector<Edge>> out_edges_;
+    vector<vector<uint32_t>> aligned_nodes_;
+    vector<uint32_t> order_;
+
+    // alignment arena
+    vector<int32_t> scores_;
+    vector<int32_t> start_row_;
+    vector<int32_t> profile_;
+    vector<uint32_t> row_offsets_;
+    vector<uint32_t> band_begin_;
+    vector<uint32_t> band_end_;
+    vector<uint32_t> min_distance_;
+    vector<uint32_t> max_distance_;
+    vector<AlignedPair> alignment_;
+    uint32_t seq_len_;
+};
+
+
+/**
+ * @brief Returns the name of the row kernel selected for this CPU.
+ * @return One of "avx2", "sse4.1" or "scalar".
+ */
+const char *poa_kernel_name();
+
+
+#endif  // POA_KERNEL_H
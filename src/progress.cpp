@@ -0,0 +1,77 @@
+/**
+ * @file progress.cpp
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the ProgressReporter class.
+ * @details Implementation file for the ProgressReporter class. The reporter
+ * prints the progress of parallel tasks from a dedicated thread, so that
+ * workers never block on the standard output.
+ */
+#include <iostream>
+#include <chrono>
+#include <string>
+
+#include "progress.h"
+
+
+using std::cout;
+using std::endl;
+using std::mutex;
+using std::unique_lock;
+using std::lock_guard;
+
+
+ProgressReporter::ProgressReporter(const string& tag, const string& task,
+                                   uint64_t total, uint32_t interval_ms):
+        tag_(tag), task_(task), total_(total), interval_ms_(interval_ms),
+        done_(0), last_reported_(0), lease_(IO_THREADS, 1),
+        stopping_(false) {
+    reporter_ = std::thread(&ProgressReporter::report_loop, this);
+}
+
+
+ProgressReporter::~ProgressReporter() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    stop_cv_.notify_all();
+    reporter_.join();
+
+    // always print the final state
+    last_reported_ = total_ + 1;
+    report();
+}
+
+
+void ProgressReporter::report_loop() {
+    unique_lock<mutex> lock(mutex_);
+
+    while (!stopping_) {
+        stop_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms_),
+                          [this] { return stopping_; });
+
+        if (!stopping_) {
+            report();
+        }
+    }
+}
+
+
+void ProgressReporter::report() {
+    // allocation changes of leases taken by workers
+    ResourceManager::get_instance().log_allocation();
+
+    uint64_t done = done_.load(std::memory_order_relaxed);
+
+    if (done == last_reported_) {
+        return;
+    }
+
+    last_reported_ = done;
+
+    double percentage = total_ > 0 ? 100.0 * done / total_ : 100.0;
+    cout << "[" << tag_ << "] " << task_ << ": " << done << "/" << total_
+        << " (" << static_cast<int>(percentage) << "%)" << endl;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file progress.h
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the ProgressReporter class.
+ * @details Header file for the ProgressReporter class. The reporter prints
+ * the progress of parallel tasks from a dedicated thread, so that workers
+ * never block on the standard output.
+ */
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <cstdint>
+
+#include "resources.h"
+
+
+using std::string;
+
+
+/**
+ * @brief Default minimum time between two progress reports in milliseconds
+ */
+#define PROGRESS_INTERVAL_MS 2000
+
+
+/**
+ * @brief Rate limited progress reporter.
+ * @details Workers report finished tasks with the advance method, which only
+ * increments an atomic counter. A reporter thread wakes up periodically and
+ * prints the progress if it changed since the last report. The final state is
+ * always printed when the reporter is destroyed.
+ */
+class ProgressReporter {
+ public:
+    /**
+     * @brief ProgressReporter class constructor.
+     * @details Starts the reporter thread.
+     *
+     * @param tag log tag, e.g. "EXTENDER"
+     * @param task description of a finished task, e.g. "Extended contigs"
+     * @param total total number of tasks
+     * @param interval_ms minimum time between two reports in milliseconds
+     */
+    ProgressReporter(const string& tag, const string& task, uint64_t total,
+                     uint32_t interval_ms = PROGRESS_INTERVAL_MS);
+
+
+    /**
+     * @brief ProgressReporter class destructor.
+     * @details Stops the reporter thread and prints the final progress.
+     */
+    ~ProgressReporter();
+
+
+    /**
+     * @brief Reports finished tasks, never blocks.
+     *
+     * @param tasks number of finished tasks
+     */
+    void advance(uint64_t tasks = 1) {
+        done_.fetch_add(tasks, std::memory_order_relaxed);
+    }
+
+ private:
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    /**
+     * @brief Main loop of the reporter thread.
+     */
+    void report_loop();
+
+    /**
+     * @brief Prints the progress if it changed since the last report.
+     */
+    void report();
+
+    // log tag
+    string tag_;
+    // description of a finished task
+    string task_;
+    // total number of tasks
+    uint64_t total_;
+    // minimum time between two reports
+    uint32_t interval_ms_;
+
+    // number of finished tasks
+    std::atomic<uint64_t> done_;
+    // number of finished tasks at the last report
+    uint64_t last_reported_;
+
+    // the reporter thread is accounted for in the thread budget
+    ThreadLease lease_;
+
+    // used only to wake the reporter thread when stopping
+    std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_;
+
+    // reporter thread
+    std::thread reporter_;
+};
+
+
+#endif  // PROGRESS_H
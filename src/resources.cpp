@@ -0,0 +1,111 @@
+/**
+ * @file resources.cpp
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the ResourceManager and ThreadLease classes.
+ * @details Implementation file for the ResourceManager and ThreadLease
+ * classes. The resource manager splits the thread budget given with the -t
+ * flag between external aligner processes, in-process workers and I/O
+ * threads.
+ */
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "resources.h"
+#include "utility.h"
+
+
+using std::min;
+using std::max;
+using std::lock_guard;
+using std::mutex;
+using std::cout;
+using std::endl;
+
+
+// static initialization runs on the main thread
+static const std::thread::id main_thread_id = std::this_thread::get_id();
+
+
+ResourceManager::ResourceManager(uint32_t budget): budget_(max(1u, budget)),
+        changed_(false) {
+    for (int i = 0; i < NUM_THREAD_ROLES; ++i) {
+        allocated_[i] = 0;
+        last_granted_[i] = 0;
+    }
+}
+
+
+ResourceManager& ResourceManager::get_instance() {
+    static ResourceManager instance(utility::get_concurrency_level());
+    return instance;
+}
+
+
+uint32_t ResourceManager::acquire(ThreadRole role, uint32_t requested) {
+    lock_guard<mutex> lock(mutex_);
+
+    uint32_t used = 0;
+    for (int i = 0; i < NUM_THREAD_ROLES; ++i) {
+        used += allocated_[i];
+    }
+
+    uint32_t free = used < budget_ ? budget_ - used : 0;
+    uint32_t granted = max(1u, min(requested, free));
+
+    allocated_[role] += granted;
+
+    if (granted != last_granted_[role]) {
+        changed_ = true;
+    }
+    last_granted_[role] = granted;
+
+    return granted;
+}
+
+
+void ResourceManager::release(ThreadRole role, uint32_t threads) {
+    lock_guard<mutex> lock(mutex_);
+    allocated_[role] -= min(threads, allocated_[role]);
+}
+
+
+string ResourceManager::allocation_summary() {
+    lock_guard<mutex> lock(mutex_);
+
+    return utility::create_seq_id(
+        "aligners %u, workers %u, io %u of %u threads",
+        allocated_[ALIGNER_THREADS], allocated_[WORKER_THREADS],
+        allocated_[IO_THREADS], budget_);
+}
+
+
+void ResourceManager::log_allocation() {
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        if (!changed_) {
+            return;
+        }
+        changed_ = false;
+    }
+
+    cout << "[RESOURCES] Allocation: " << allocation_summary() << endl;
+}
+
+
+ThreadLease::ThreadLease(ThreadRole role, uint32_t requested): role_(role) {
+    auto& manager = ResourceManager::get_instance();
+    threads_ = manager.acquire(role, requested);
+
+    if (std::this_thread::get_id() == main_thread_id) {
+        manager.log_allocation();
+    }
+}
+
+
+ThreadLease::~ThreadLease() {
+    ResourceManager::get_instance().release(role_, threads_);
+}
@@ -0,0 +1,162 @@
+/**
+ * @file resources.h
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the ResourceManager and ThreadLease classes.
+ * @details Header file for the ResourceManager and ThreadLease classes. The
+ * resource manager splits the thread budget given with the -t flag between
+ * external aligner processes, in-process workers and I/O threads.
+ */
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+
+using std::string;
+
+
+/**
+ * @brief Enum used to distinguish the consumers of the thread budget.
+ */
+enum ThreadRole {
+    ALIGNER_THREADS = 0,
+    WORKER_THREADS = 1,
+    IO_THREADS = 2
+};
+
+/**
+ * @brief The number of different thread roles
+ */
+#define NUM_THREAD_ROLES 3
+
+
+/**
+ * @brief Global thread budget manager.
+ * @details The manager keeps track of how many threads of the budget are
+ * currently allocated to each role. Requests are never blocking: a request
+ * receives the free part of the budget up to the requested amount, but at
+ * least one thread. Every consumer is started from a thread which idles while
+ * waiting for it, e.g. a worker waiting for the aligner process, so this
+ * single thread is always available. Whenever the size of a grant differs
+ * from the previous grant for the same role the allocation is marked as
+ * changed. Workers never write it to the run log themselves, the change is
+ * logged by the main thread or by a progress reporter, see log_allocation.
+ */
+class ResourceManager {
+ public:
+    /**
+     * @brief Getter for the shared instance.
+     * @details The instance is created on first use with the budget returned
+     * by utility::get_concurrency_level().
+     *
+     * @return shared ResourceManager instance
+     */
+    static ResourceManager& get_instance();
+
+
+    /**
+     * @brief Allocates threads to the given role.
+     *
+     * @param role consumer of the threads
+     * @param requested the maximum number of threads wanted
+     *
+     * @return the number of allocated threads, at least 1
+     */
+    uint32_t acquire(ThreadRole role, uint32_t requested);
+
+
+    /**
+     * @brief Returns previously acquired threads to the budget.
+     *
+     * @param role consumer of the threads
+     * @param threads number of threads returned by acquire
+     */
+    void release(ThreadRole role, uint32_t threads);
+
+
+    /**
+     * @brief Getter for the total thread budget.
+     * @return Total number of threads.
+     */
+    uint32_t budget() const { return budget_; }
+
+
+    /**
+     * @brief Describes the current allocation.
+     * @return Human readable description of the allocation for the run log.
+     */
+    string allocation_summary();
+
+
+    /**
+     * @brief Writes the allocation to the run log if it changed.
+     * @details Only the main thread and progress reporter threads may call
+     * this method, so that workers never block on the standard output.
+     */
+    void log_allocation();
+
+ private:
+    /**
+     * @brief ResourceManager class constructor.
+     *
+     * @param budget total number of threads
+     */
+    explicit ResourceManager(uint32_t budget);
+
+    // total number of threads
+    uint32_t budget_;
+    // threads allocated per role
+    uint32_t allocated_[NUM_THREAD_ROLES];
+    // size of the last grant per role, used to log only changes
+    uint32_t last_granted_[NUM_THREAD_ROLES];
+    // true if a grant changed since the allocation was last logged
+    bool changed_;
+    // guards the allocation
+    std::mutex mutex_;
+};
+
+
+/**
+ * @brief Scoped allocation of threads from the ResourceManager.
+ * @details Threads are acquired in the constructor and released in the
+ * destructor.
+ */
+class ThreadLease {
+ public:
+    /**
+     * @brief ThreadLease class constructor.
+     * @details A lease taken on the main thread logs a changed allocation.
+     *
+     * @param role consumer of the threads
+     * @param requested the maximum number of threads wanted
+     */
+    ThreadLease(ThreadRole role, uint32_t requested);
+
+
+    /**
+     * @brief ThreadLease class destructor.
+     */
+    ~ThreadLease();
+
+
+    /**
+     * @brief Getter for the number of leased threads.
+     * @return Number of leased threads.
+     */
+    uint32_t threads() const { return threads_; }
+
+ private:
+    ThreadLease(const ThreadLease&) = delete;
+    ThreadLease& operator=(const ThreadLease&) = delete;
+
+    // consumer of the threads
+    ThreadRole role_;
+    // number of leased threads
+    uint32_t threads_;
+};
+
+
+#endif  // RESOURCES_H
@@ -9,6 +9,7 @@
  */
 
 #include <string>
+#include <algorithm>
 
 #include "scaffold.h"
 #include "utility.h"
@@ -16,32 +17,36 @@
 
 Scaffold::Scaffold(Contig *first_contig) {
     contigs.emplace_back(first_contig);
-    contig_ids.insert(utility::CharString_to_string(first_contig->id()));
     contributions.emplace_back(0, first_contig->total_len());
 }
 
 
 void Scaffold::add_contig(Contig *contig, int last_end, int this_start) {
     contigs.emplace_back(contig);
-    contig_ids.insert(utility::CharString_to_string(contig->id()));
     contributions[contributions.size() - 1].second = last_end;
     contributions.emplace_back(this_start, contig->total_len());
 }
 
 
-Dna5String Scaffold::get_combined_sequence() {
-    string seq;
+vector<SequenceSlice> Scaffold::slices() {
+    vector<SequenceSlice> result;
+    result.reserve(contigs.size());
 
     for (size_t i = 0; i < contigs.size(); ++i) {
-        auto &contig = contigs[i];
-        string contig_seq = utility::Dna5String_to_string(contig->seq());
-
-        seq += contig_seq.substr(contributions[i].first, contributions[i].second
-                                 - contributions[i].first);
+        result.push_back(contigs[i]->slice(contributions[i].first,
+                                           contributions[i].second));
     }
 
-    Dna5String dna_string = seq;
-    return dna_string;
+    return result;
+}
+
+
+uint64_t Scaffold::length() const {
+    uint64_t total = 0;
+    for (auto const& contribution : contributions) {
+        total += contribution.second - contribution.first;
+    }
+    return total;
 }
 
 
@@ -56,9 +61,34 @@ void Scaffold::merge(Scaffold *scaffold) {
     contigs.insert(contigs.end(),
                    scaffold->contigs.begin() + 1,
                    scaffold->contigs.end());
+}
 
-    contig_ids.insert(scaffold->contig_ids.begin(),
-                      scaffold->contig_ids.end());
+
+void Scaffold::append(Scaffold *scaffold, int last_end, int this_start) {
+    contributions[contributions.size() - 1].second = last_end;
+
+    int size = num_contigs();
+    contributions.insert(contributions.end(),
+                         scaffold->contributions.begin(),
+                         scaffold->contributions.end());
+    contributions[size].first = this_start;
+
+    contigs.insert(contigs.end(),
+                   scaffold->contigs.begin(),
+                   scaffold->contigs.end());
+}
+
+
+void Scaffold::reverse_complement() {
+    std::reverse(contigs.begin(), contigs.end());
+    std::reverse(contributions.begin(), contributions.end());
+
+    for (size_t i = 0; i < contigs.size(); ++i) {
+        int len = contigs[i]->total_len();
+        contributions[i] = {len - contributions[i].second,
+                            len - contributions[i].first};
+        contigs[i]->reverse_complement();
+    }
 }
 
 
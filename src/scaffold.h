@@ -11,7 +11,6 @@
 #define SCAFFOLD_H
 
 #include <vector>
-#include <unordered_set>
 #include <utility>
 #include <string>
 
@@ -19,7 +18,6 @@
 
 
 using std::vector;
-using std::unordered_set;
 using std::pair;
 using std::string;
 
@@ -58,23 +56,20 @@ class Scaffold {
 
 
     /**
-     * @brief Checks if scaffold contains contig with given Id.
-     * 
-     * @param id Contig Id.
-     * @return True if contains, false otherwise.
+     * @brief Method describes the scaffold sequence as contig slices.
+     * @details The scaffold sequence is the concatenation of the
+     * contributions of its contigs. The slices refer to the contig
+     * sequences, which must not change while the slices are used.
+     * @return Slices of the scaffold sequence in order.
      */
-    bool contains(const string& id) { return contig_ids.count(id) > 0; }
+    vector<SequenceSlice> slices();
 
 
     /**
-     * @brief Method creates unified scaffold sequence.
-     * @details One scaffold sequence is generated from
-     * multiple contig sequences. Depending on contributions
-     * of each contig, subsequences from contig sequences
-     * are extracted and connected with each other. 
-     * @return Scaffold sequence.
+     * @brief Getter for the length of the scaffold sequence.
+     * @return Length of the scaffold sequence.
      */
-    Dna5String get_combined_sequence();
+    uint64_t length() const;
 
 
     /**
@@ -116,6 +111,28 @@ class Scaffold {
     void merge(Scaffold *scaffold);
 
 
+    /**
+     * @brief Appends a scaffold which does not share a contig with this one.
+     * @details All contigs of the given scaffold are inserted after the last
+     * contig of this scaffold, the contributions of the two contigs at the
+     * joint are updated.
+     *
+     * @param scaffold Scaffold to append to this one.
+     * @param last_end End contribution index of previously last contig.
+     * @param this_start Start contribution index of the first contig of the
+     * appended scaffold.
+     */
+    void append(Scaffold *scaffold, int last_end, int this_start);
+
+
+    /**
+     * @brief Reverse complements the scaffold.
+     * @details The order of the contigs is reversed and every contig is
+     * reverse complemented, the contributions are mirrored accordingly.
+     */
+    void reverse_complement();
+
+
     /**
      * @brief Trim scaffold if it is circular.
      * @details Only contributions of first and last contig
@@ -138,10 +155,6 @@ class Scaffold {
     // Only subsequences in this interval contribute
     // to scaffold sequence.
     vector<pair<int, int>> contributions;
-
-
-    // Ids of contigs scaffold consits of.
-    unordered_set<string> contig_ids;
 };
 
 
@@ -13,26 +13,36 @@
 #include <string>
 #include <iostream>
 #include <utility>
-#include <memory>
 #include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 
 #include "aligners/aligner.h"
 #include "utility.h"
 #include "scaffolder.h"
 #include "extension.h"
 #include "bases.h"
+#include "vote_kernel.h"
+#include "edit_distance.h"
+#include "extension_cache.h"
 
 
 #define INNER_MARGIN 5  // margin for soft clipping port on read ends
 #define OUTER_MARGIN 15
 #define MIN_COVERAGE 5  // minimum coverage for position
+#define RECOVERY_ERROR_RATE 0.3  // allowed errors per base in read recovery
+#define RECOVERY_MIN_ERRORS 2
+#define RECOVERY_MIN_LENGTH 16  // shorter alignments have ambiguous ends
+#define LOOKAHEAD_DEPTH 16  // extension bases used to resynchronise a read
+#define LOOKAHEAD_ERROR_DIVISOR 3  // one error allowed per 3 lookahead bases
+#define MIN_GAIN_RATE 0.0  // extension bases per second of aligner time
 
 
 using std::vector;
 using std::string;
 using std::reverse;
 using std::pair;
-using std::shared_ptr;
 using std::unordered_map;
 
 using seqan::CharString;
@@ -54,11 +64,25 @@ int max_ext_length = 1000;
 int inner_margin = 5;
 int outer_margin = 15;
 int min_coverage = 5;
+int lookahead_depth = LOOKAHEAD_DEPTH;
+double min_gain_rate = MIN_GAIN_RATE;
 
 
-const char *tmp_contig_file = "tmp/extend_contig.fasta";
-const char *tmp_reads_file = "tmp/realign_reads.fasta";
-const char *tmp_sam_file = "tmp/realign.sam";
+// realignment statistics, shared by all workers
+std::atomic<uint64_t> lookahead_reads(0);
+std::atomic<uint64_t> recovered_reads(0);
+std::atomic<uint64_t> saved_rounds(0);
+std::atomic<uint64_t> total_rounds(0);
+std::atomic<uint64_t> aligner_rounds(0);
+std::atomic<uint64_t> aligner_micros(0);
+std::atomic<uint64_t> policy_stops(0);
+
+
+// temporary files, formatted with the worker index
+const char *tmp_contig_file = "tmp/extend_contig_%u.fasta";
+const char *tmp_reads_file = "tmp/realign_reads_%u.fasta";
+const char *tmp_reads_fastq_file = "tmp/realign_reads_%u.fastq";
+const char *tmp_sam_file = "tmp/realign_%u.sam";
 
 
 void set_max_extension_len(int length) {
@@ -97,15 +121,52 @@ void set_min_coverage(int coverage) {
 }
 
 
+void set_lookahead_depth(int depth) {
+    if (depth >= 0) {
+        lookahead_depth = depth;
+    } else {
+        utility::exit_with_message("Illegal lookahead depth");
+    }
+}
+
+
+void set_min_gain_rate(double rate) {
+    if (rate >= 0) {
+        min_gain_rate = rate;
+    } else {
+        utility::exit_with_message("Illegal minimum gain rate");
+    }
+}
+
+
+RealignStats get_realign_stats() {
+    RealignStats stats;
+    stats.lookahead_reads = lookahead_reads;
+    stats.recovered_reads = recovered_reads;
+    stats.saved_rounds = saved_rounds;
+    stats.rounds = total_rounds;
+    stats.aligner_rounds = aligner_rounds;
+    stats.aligner_seconds = aligner_micros / 1e6;
+    stats.policy_stops = policy_stops;
+    return stats;
+}
+
+
 void find_possible_extensions(const vector<BamAlignmentRecord>& aln_records,
-                              vector<shared_ptr<Extension>>* pleft_ext_reads,
-                              vector<shared_ptr<Extension>>* pright_ext_reads,
+                              ExtensionSet* pleft_ext_reads,
+                              ExtensionSet* pright_ext_reads,
                               const unordered_map<string, uint32_t>&
                               read_name_to_id,
                               uint64_t contig_len) {
     auto& left_ext_reads = *pleft_ext_reads;
     auto& right_ext_reads = *pright_ext_reads;
 
+    // qualities of the read bases from start, nullptr if the record has none
+    auto qualities_from = [](const string& qual, const string& seq,
+                             uint32_t start) -> const char* {
+        return qual.length() == seq.length() ? qual.data() + start : nullptr;
+    };
+
     for (auto const& record : aln_records) {
         // get read name as cpp string
         String<char, CStyle> tmp_name = record.qName;
@@ -125,6 +186,8 @@ void find_possible_extensions(const vector<BamAlignmentRecord>& aln_records,
             int len = record.cigar[0].count - record.beginPos;
             String<char, CStyle> tmp = record.seq;
             string seq(tmp);
+            String<char, CStyle> tmp_qual = record.qual;
+            string qual(tmp_qual);
 
             uint32_t read_id = read_name_to_id.find(read_name)->second;
 
@@ -134,19 +197,22 @@ void find_possible_extensions(const vector<BamAlignmentRecord>& aln_records,
                     start = 0;
                 }
 
-                string extension = seq.substr(start, max_ext_length);
-                // reverse it because when searching for next base
+                // records without a sequence (SEQ is '*') are skipped
+                if ((size_t) start >= seq.length()) {
+                    continue;
+                }
+
+                uint32_t ext_len = std::min<size_t>(max_ext_length,
+                                                    seq.length() - start);
+
+                // store it reversed because when searching for next base
                 // in contig extension on left side we're moving
                 // in direction right to left: <--------
-                reverse(extension.begin(), extension.end());
-
-                shared_ptr<Extension> ext(new Extension(
-                    read_id, extension, false));
-                left_ext_reads.emplace_back(ext);
+                left_ext_reads.add_reversed(read_id, seq.data() + start,
+                                            ext_len, false,
+                                            qualities_from(qual, seq, start));
             } else {
-                shared_ptr<Extension> ext(new Extension(
-                    read_id, string(), true));
-                left_ext_reads.emplace_back(ext);
+                left_ext_reads.add(read_id, nullptr, 0, true);
             }
         }
 
@@ -192,23 +258,122 @@ void find_possible_extensions(const vector<BamAlignmentRecord>& aln_records,
 
             String<char, CStyle> tmp = record.seq;
             string seq(tmp);
+            String<char, CStyle> tmp_qual = record.qual;
+            string qual(tmp_qual);
+
+            uint32_t start = used_read_size + (right_clipping_len - len);
+            if (start >= seq.length()) {
+                continue;
+            }
 
-            string extension = seq.substr(
-                used_read_size + (right_clipping_len - len),
-                max_ext_length);
+            uint32_t ext_len = std::min<size_t>(max_ext_length,
+                                                seq.length() - start);
 
             uint32_t read_id = read_name_to_id.find(read_name)->second;
             bool drop = margin > INNER_MARGIN;
-            shared_ptr<Extension> ext(new Extension(read_id,
-                drop ? string() : extension, drop));
-             right_ext_reads.emplace_back(ext);
+            right_ext_reads.add(read_id, seq.data() + start,
+                                drop ? 0 : ext_len, drop,
+                                qualities_from(qual, seq, start));
+        }
+    }
+}
+
+
+// superset of the records used by find_possible_extensions
+static bool is_end_record(const BamAlignmentRecord& record,
+                          uint64_t contig_len) {
+    if ((record.flag & UNMAPPED) != 0 || length(record.cigar) == 0) {
+        return false;
+    }
+
+    if (record.cigar[0].operation == 'S' && record.beginPos < OUTER_MARGIN) {
+        return true;
+    }
+
+    if (record.cigar[length(record.cigar) - 1].operation != 'S') {
+        return false;
+    }
+
+    uint64_t contig_end = record.beginPos;
+    for (auto const& e : record.cigar) {
+        if (utility::contributes_to_contig_len(e.operation)) {
+            contig_end += e.count;
+        }
+    }
+
+    return contig_end + OUTER_MARGIN >= contig_len;
+}
+
+
+// adds the extension method and settings to the hash
+static void hash_settings(const string& method, ContentHash *phash) {
+    auto& hash = *phash;
+    hash.update(method);
+
+    int64_t gain_rate_bits;
+    memcpy(&gain_rate_bits, &min_gain_rate, sizeof(gain_rate_bits));
+
+    hash.update(max_ext_length);
+    hash.update(inner_margin);
+    hash.update(outer_margin);
+    hash.update(min_coverage);
+    hash.update(lookahead_depth);
+    hash.update(gain_rate_bits);
+    hash.update(bases::get_vote_mode());
+}
+
+
+string settings_key(const string& method) {
+    ContentHash hash;
+    hash_settings(method, &hash);
+    return hash.hex();
+}
+
+
+string extension_key(const Dna5String& contig_seq,
+                     const vector<BamAlignmentRecord>& aln_records,
+                     const unordered_map<string, uint32_t>& read_name_to_id,
+                     const StringSet<Dna5String>& read_seqs,
+                     const StringSet<CharString>& read_quals,
+                     const string& method) {
+    ContentHash hash;
+    hash_settings(method, &hash);
+
+    hash.update(utility::Dna5String_to_string(contig_seq));
+
+    bool use_quals = length(read_quals) == length(read_seqs);
+
+    for (auto const& record : aln_records) {
+        if (!is_end_record(record, length(contig_seq))) {
+            continue;
+        }
+
+        string read_name = utility::CharString_to_string(record.qName);
+        hash.update(read_name);
+        hash.update(record.flag);
+        hash.update(record.beginPos);
+
+        for (auto const& e : record.cigar) {
+            hash.update(e.operation);
+            hash.update(e.count);
+        }
+
+        // realigned reads are taken from the read set
+        auto it = read_name_to_id.find(read_name);
+        if (it != read_name_to_id.end()) {
+            hash.update(utility::Dna5String_to_string(read_seqs[it->second]));
+            if (use_quals) {
+                hash.update(utility::CharString_to_string(
+                    read_quals[it->second]));
+            }
         }
     }
+
+    return hash.hex();
 }
 
 
-string get_extension_mv_simple(
-    const vector<shared_ptr<Extension>>& extensions) {
+string get_extension_mv_simple(const ExtensionSet& extensions) {
     // calculate extension by majority vote
     string extension("");
 
@@ -236,12 +401,25 @@ string get_extension_mv_simple(
 }
 
 
-string get_extension_mv_realign(
-    const vector<shared_ptr<Extension>>& extensions) {
+string get_extension_mv_realign(ExtensionSet& extensions,
+                                uint32_t *precovered) {
     string contig_ext("");
 
+    // reads waiting for lookahead_depth extension bases to be resynchronised
+    vector<DroppedRead> pending;
+    uint32_t pending_head = 0;
+    uint32_t resynced = 0;
+
+    // reads which could not be resynchronised
+    vector<DroppedRead> dropped;
+
+    bases::VoteBuffer vote_buffer;
+    bases::ColumnVotes votes;
+
     for (uint32_t i = 0; true; ++i) {
-        BasesCounter bases = bases::count_bases(extensions);
+        // current and next column histograms in a single pass
+        bases::count_columns(extensions, &vote_buffer, &votes);
+        const BasesCounter& bases = votes.current;
 
         if (bases.coverage >= MIN_COVERAGE) {
             char output_base = utility::idx_to_base(bases.max_idx);
@@ -255,15 +433,9 @@ string get_extension_mv_realign(
                 std::cerr << std::endl;
             )
 
-            // realignment
-            auto is_read_eligible = [output_base](char c) -> bool {
-                return c == output_base;
-            };
-
-            // majority vote for next base
-            BasesCounter next_bases = bases::count_bases(extensions,
-                                                         is_read_eligible,
-                                                         1);
+            // majority vote for next base over reads agreeing with the
+            // output base
+            const BasesCounter& next_bases = votes.next[bases.max_idx];
 
             char next_mv = utility::idx_to_base(next_bases.max_idx);
 
@@ -281,40 +453,64 @@ string get_extension_mv_realign(
             contig_ext.push_back(output_base);
 
             // cigar operation check
-            for (size_t j = 0; j < extensions.size(); ++j) {
-                auto& extension = extensions[j];
-                auto& seq = extension->seq();
-
+            uint32_t size = extensions.size();
+            for (uint32_t j = 0; j < size; ++j) {
                 // skip dropped reads
-                if (extension->is_droped) {
+                if (extensions.is_dropped(j)) {
                     continue;
                 }
 
+                uint32_t position = extensions.curr_pos(j);
+
                 // skip extensions which don't have at least 2 bases left
-                if (extension->curr_pos() >= seq.length() - 2) {
-                    extension->is_droped = true;
+                if (position + 2 >= extensions.length(j)) {
+                    extensions.drop(j);
                     continue;
                 }
 
-                char current_base = seq[extension->curr_pos()];
-                char next_base = seq[extension->curr_pos() + 1];
+                const char *seq = extensions.seq(j);
+                char current_base = seq[position];
+                char next_base = seq[position + 1];
 
                 if (current_base == output_base) {
                     // if operation is hit move forward
-                    extension->do_operation(match);
+                    extensions.do_operation(j, match);
                 } else if (current_base == next_mv) {
                     // if operation is a deletion stay - do nothing
-                    extension->do_operation(deletion_1);
+                    extensions.do_operation(j, deletion_1);
                 } else if (next_base == next_mv) {
                     // if operation is a mismatch move forward
-                    extension->do_operation(mismatch);
+                    extensions.do_operation(j, mismatch);
                 } else if (next_base == output_base) {
                     // if operation is an insertion skip one and
                     // move to the next one
-                    extension->do_operation(insertion_1);
+                    extensions.do_operation(j, insertion_1);
                 } else {
-                    // drop read
-                    extension->is_droped = true;
+                    // drop read, resynchronised later if possible
+                    extensions.drop(j);
+
+                    if (lookahead_depth > 0) {
+                        pending.push_back({j, i});
+                    } else {
+                        dropped.push_back({j, i});
+                    }
+                }
+            }
+
+            // lookahead over multi-base indels, once the extension has
+            // lookahead_depth bases past the drop column the read is aligned
+            // to them and continues from the next column
+            uint32_t max_errors = lookahead_depth / LOOKAHEAD_ERROR_DIVISOR;
+
+            while (pending_head < pending.size() &&
+                   contig_ext.length() - pending[pending_head].column >=
+                   (uint32_t) lookahead_depth) {
+                const auto& read = pending[pending_head++];
+
+                if (resync_read(extensions, contig_ext, read, max_errors)) {
+                    ++resynced;
+                } else {
+                    dropped.push_back(read);
                 }
             }
 
@@ -325,17 +521,99 @@ string get_extension_mv_realign(
         }
     }
 
+    // reads still waiting for the lookahead are left to the recovery
+    dropped.insert(dropped.end(), pending.begin() + pending_head,
+                   pending.end());
+
+    uint32_t recovered = recover_dropped_reads(extensions, contig_ext,
+                                               dropped);
+    DEBUG("Resynchronised " << resynced << ", recovered " << recovered
+          << " of " << dropped.size() << " reads")
+
+    lookahead_reads += resynced;
+    recovered_reads += recovered;
+
+    if (precovered != nullptr) {
+        *precovered = resynced + recovered;
+    }
+
     return contig_ext;
 }
 
 
+bool resync_read(ExtensionSet& extensions, const string& extension,
+                 const DroppedRead& read, uint32_t max_errors) {
+    uint32_t position = extensions.curr_pos(read.idx);
+    uint32_t read_len = extensions.length(read.idx);
+
+    // the read was in sync with the extension at the drop column
+    const char *pattern = extension.data() + read.column;
+    uint32_t pattern_len = extension.length() - read.column;
+
+    edit_distance::PrefixAlignment alignment;
+    bool aligned = edit_distance::align_prefix(
+        pattern, pattern_len,
+        extensions.seq(read.idx) + position, read_len - position,
+        max_errors, &alignment);
+
+    if (!aligned) {
+        return false;
+    }
+
+    uint32_t new_position = position + alignment.text_end;
+
+    // resynchronised reads need at least 2 bases for the next realignment
+    if (new_position + 2 < read_len) {
+        extensions.restore(read.idx, new_position);
+        return true;
+    }
+
+    return false;
+}
+
+
+uint32_t recover_dropped_reads(ExtensionSet& extensions,
+                               const string& extension,
+                               const vector<DroppedRead>& dropped) {
+    uint32_t recovered = 0;
+
+    for (const auto& read : dropped) {
+        uint32_t pattern_len = extension.length() - read.column;
+
+        if (pattern_len < RECOVERY_MIN_LENGTH) {
+            continue;
+        }
+
+        uint32_t max_errors = std::max<uint32_t>(RECOVERY_MIN_ERRORS,
+            RECOVERY_ERROR_RATE * pattern_len);
+
+        if (resync_read(extensions, extension, read, max_errors)) {
+            ++recovered;
+        }
+    }
+
+    return recovered;
+}
+
+
 Contig* extend_contig(Dna5String& contig_seq,
                       const vector<BamAlignmentRecord>& aln_records,
                       const unordered_map<string, uint32_t>& read_name_to_id,
                       const StringSet<CharString>& read_ids,
-                      const StringSet<Dna5String>& read_seqs) {
-    vector<shared_ptr<Extension>> left_extensions;
-    vector<shared_ptr<Extension>> right_extensions;
+                      const StringSet<Dna5String>& read_seqs,
+                      const StringSet<CharString>& read_quals,
+                      uint32_t worker_id,
+                      vector<RoundStats>* pround_stats) {
+    // dropped reads keep their qualities through the realignment
+    bool use_quals = length(read_quals) == length(read_seqs);
+
+    string contig_file = utility::create_seq_id(tmp_contig_file, worker_id);
+    string reads_file = utility::create_seq_id(
+        use_quals ? tmp_reads_fastq_file : tmp_reads_file, worker_id);
+    string sam_file = utility::create_seq_id(tmp_sam_file, worker_id);
+
+    ExtensionSet left_extensions;
+    ExtensionSet right_extensions;
 
     find_possible_extensions(aln_records,
                          &left_extensions,
@@ -349,17 +627,26 @@ Contig* extend_contig(Dna5String& contig_seq,
     int total_left_ext = 0;
     int total_right_ext = 0;
 
+    vector<RoundStats> rounds;
+
+    // aligner time which produced the reads of the current round
+    double last_aligner_seconds = 0;
+
     DEBUG("Total start: " << length(contig_seq))
 
     while (should_ext_left || should_ext_right) {
         string left_extension;
         string right_extension;
 
+        uint32_t left_recovered = 0;
+        uint32_t right_recovered = 0;
+
         // do left extension if needed
         if (should_ext_left) {
             DEBUG("Left extension:")
 
-            left_extension = get_extension_mv_realign(left_extensions);
+            left_extension = get_extension_mv_realign(left_extensions,
+                                                      &left_recovered);
             reverse(left_extension.begin(), left_extension.end());
             should_ext_left = !left_extension.empty();
 
@@ -370,7 +657,8 @@ Contig* extend_contig(Dna5String& contig_seq,
         if (should_ext_right) {
             DEBUG("Right extension:")
 
-            right_extension = get_extension_mv_realign(right_extensions);
+            right_extension = get_extension_mv_realign(right_extensions,
+                                                       &right_recovered);
 
             should_ext_right = !right_extension.empty();
 
@@ -380,6 +668,13 @@ Contig* extend_contig(Dna5String& contig_seq,
         should_ext_left = should_ext_left && total_left_ext < max_ext_length;
         should_ext_right = should_ext_right && total_right_ext < max_ext_length;
 
+        rounds.emplace_back();
+        RoundStats& round = rounds.back();
+        round.bases_gained = left_extension.length() + right_extension.length();
+        round.dropped_reads = 0;
+        round.rescued_reads = left_recovered + right_recovered;
+        round.aligner_seconds = 0;
+
         DEBUG_BLOCK(
             std::cerr << "TR: " << total_right_ext << " " << right_extension;
             std::cerr << std::endl << "SER: " << should_ext_right << ", SEL: ";
@@ -392,75 +687,96 @@ Contig* extend_contig(Dna5String& contig_seq,
         tmp_contig_seq += right_extension;
         contig_seq = tmp_contig_seq;
 
-        // prepare structure for realignment
-        utility::write_fasta("contig", contig_seq, tmp_contig_file);
-
         StringSet<CharString> dropped_read_ids;
         StringSet<Dna5String> dropped_read_seqs;
-
-        vector<shared_ptr<Extension>> tmp_left_extensions;
-        vector<shared_ptr<Extension>> tmp_right_extensions;
+        StringSet<CharString> dropped_read_quals;
 
         vector<bool> realign_reads(length(read_ids), false);
         bool will_realign = false;
 
-        // check which left extending reads need to be realigned
-        for (auto& ext : left_extensions) {
-            if (ext->is_droped) {
-                int read_id = ext->read_id();
-
-                if (!realign_reads[read_id]) {
-                    realign_reads[read_id] = true;
-                    appendValue(dropped_read_ids, read_ids[read_id]);
-                    appendValue(dropped_read_seqs, read_seqs[read_id]);
-                    will_realign = true;
+        // check which extending reads need to be realigned
+        for (auto extensions : { &left_extensions, &right_extensions }) {
+            for (uint32_t j = 0; j < extensions->size(); ++j) {
+                if (!extensions->is_dropped(j)) {
+                    continue;
                 }
-            } else {
-                tmp_left_extensions.emplace_back(ext);
-            }
-        }
 
-        // check which right extending reads need to be realigned
-        for (auto& ext : right_extensions) {
-            if (ext->is_droped) {
-                int read_id = ext->read_id();
+                uint32_t read_id = extensions->read_id(j);
 
                 if (!realign_reads[read_id]) {
                     realign_reads[read_id] = true;
                     appendValue(dropped_read_ids, read_ids[read_id]);
                     appendValue(dropped_read_seqs, read_seqs[read_id]);
+                    if (use_quals) {
+                        appendValue(dropped_read_quals, read_quals[read_id]);
+                    }
                     will_realign = true;
                 }
-            } else {
-                tmp_right_extensions.emplace_back(ext);
             }
         }
 
-        // if nothing needs realignment return the current extension
+        // if nothing needs realignment continue with the recovered reads or
+        // return the current extension
         if (!will_realign) {
+            if (left_recovered + right_recovered > 0) {
+                // without the in process resynchronisation these reads would
+                // have needed an external realignment round
+                ++saved_rounds;
+                last_aligner_seconds = 0;
+                continue;
+            }
             break;
         }
 
-        // prepare the extension vectors for the next iteration
-        left_extensions.clear();
-        right_extensions.clear();
+        round.dropped_reads = length(dropped_read_ids);
 
-        left_extensions = std::move(tmp_left_extensions);
-        right_extensions = std::move(tmp_right_extensions);
+        // stop if the bases gained do not pay off the aligner time the round
+        // needed, repetitive contig ends otherwise keep realigning for a
+        // handful of bases per round
+        if (min_gain_rate > 0 && last_aligner_seconds > 0 &&
+            round.bases_gained < min_gain_rate * last_aligner_seconds) {
+            DEBUG("Gain rate below minimum, stopping realignment")
+            ++policy_stops;
+            break;
+        }
+        last_aligner_seconds = 0;
 
-        utility::write_fasta(dropped_read_ids, dropped_read_seqs,
-                             tmp_reads_file);
+        // prepare the extension sets for the next iteration
+        left_extensions.remove_dropped();
+        right_extensions.remove_dropped();
+
+        // prepare structure for realignment
+        utility::write_fasta("contig", contig_seq, contig_file.c_str());
+        if (use_quals) {
+            utility::write_fastq(dropped_read_ids, dropped_read_seqs,
+                                 dropped_read_quals, reads_file.c_str());
+        } else {
+            utility::write_fasta(dropped_read_ids, dropped_read_seqs,
+                                 reads_file.c_str());
+        }
+
+        auto aligner_start = std::chrono::steady_clock::now();
 
         // run aligner
-        Aligner::get_instance().index(tmp_contig_file);
+        Aligner::get_instance().index(contig_file.c_str());
 
-        Aligner::get_instance().align(tmp_contig_file, tmp_reads_file,
-                                      tmp_sam_file, true);
+        Aligner::get_instance().align(contig_file.c_str(), reads_file.c_str(),
+                                      sam_file.c_str(), true);
 
         // load new alignments
         BamHeader header;
         vector<BamAlignmentRecord> records;
-        utility::read_sam(&header, &records, tmp_sam_file);
+        utility::read_sam(&header, &records, sam_file.c_str());
+
+        auto aligner_micros_elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - aligner_start).count();
+
+        round.aligner_seconds = aligner_micros_elapsed / 1e6;
+        last_aligner_seconds = round.aligner_seconds;
+
+        ++aligner_rounds;
+        aligner_micros += aligner_micros_elapsed;
 
         // find the extensions for the next iteration
         find_possible_extensions(records,
@@ -477,14 +793,35 @@ Contig* extend_contig(Dna5String& contig_seq,
         }
     }
 
+    total_rounds += rounds.size();
+
+    DEBUG_BLOCK(
+        for (uint32_t r = 0; r < rounds.size(); ++r) {
+            std::cerr << "Round " << r << ": gained " << rounds[r].bases_gained
+                << ", dropped " << rounds[r].dropped_reads << ", rescued "
+                << rounds[r].rescued_reads << ", aligner "
+                << rounds[r].aligner_seconds << " s" << std::endl;
+        }
+    )
+
+    if (pround_stats != nullptr) {
+        *pround_stats = std::move(rounds);
+    }
+
     return new Contig(contig_seq, total_left_ext, total_right_ext);
 }
 
-Contig* extend_contig_poa(const Dna5String& contig_seq,
-                    const vector<BamAlignmentRecord>& aln_records,
-                    const unordered_map<string, uint32_t>& read_name_to_id) {
-    vector<shared_ptr<Extension>> left_extensions;
-    vector<shared_ptr<Extension>> right_extensions;
+void find_poa_extensions(const Dna5String& contig_seq,
+                         const vector<BamAlignmentRecord>& aln_records,
+                         const unordered_map<string, uint32_t>&
+                         read_name_to_id,
+                         vector<string>* pleft_extensions,
+                         vector<string>* pright_extensions) {
+    auto& left_poa_extensions = *pleft_extensions;
+    auto& right_poa_extensions = *pright_extensions;
+
+    ExtensionSet left_extensions;
+    ExtensionSet right_extensions;
 
     find_possible_extensions(aln_records,
                          &left_extensions,
@@ -492,26 +829,51 @@ Contig* extend_contig_poa(const Dna5String& contig_seq,
                          read_name_to_id,
                          length(contig_seq));
 
-    vector<string> extensions;
-    for (auto& ext : left_extensions) {
-        if (!ext->seq().empty()) {
-            extensions.emplace_back(ext->seq().substr(0, max_ext_length));
+    for (uint32_t j = 0; j < left_extensions.size(); ++j) {
+        if (left_extensions.length(j) > 0) {
+            left_poa_extensions.emplace_back(
+                left_extensions.extension(j, max_ext_length));
         }
     }
 
-    string left_extension = poa_consensus(extensions);
-    reverse(left_extension.begin(), left_extension.end());
-
-    extensions.clear();
-    for (auto &ext : right_extensions) {
-        if (!ext->seq().empty()) {
-            extensions.emplace_back(ext->seq().substr(0, max_ext_length));
+    for (uint32_t j = 0; j < right_extensions.size(); ++j) {
+        if (right_extensions.length(j) > 0) {
+            right_poa_extensions.emplace_back(
+                right_extensions.extension(j, max_ext_length));
         }
     }
+}
+
+
+Contig* create_contig_poa(const Dna5String& contig_seq,
+                          string left_consensus,
+                          string right_consensus) {
+    // left extensions are built right to left
+    reverse(left_consensus.begin(), left_consensus.end());
+
+    return new Contig(contig_seq, left_consensus, right_consensus);
+}
 
-    string right_extension = poa_consensus(extensions);
 
-    return new Contig(contig_seq, left_extension, right_extension);
+Contig* extend_contig_poa(const Dna5String& contig_seq,
+                    const vector<BamAlignmentRecord>& aln_records,
+                    const unordered_map<string, uint32_t>& read_name_to_id,
+                    poa_backend::PoaBackend backend) {
+    vector<string> left_extensions;
+    vector<string> right_extensions;
+
+    find_poa_extensions(contig_seq, aln_records, read_name_to_id,
+                        &left_extensions, &right_extensions);
+
+    if (backend == poa_backend::Native) {
+        NativePoa kernel;
+        string left_consensus = kernel.consensus(left_extensions);
+        return create_contig_poa(contig_seq, left_consensus,
+                                 kernel.consensus(right_extensions));
+    }
+
+    return create_contig_poa(contig_seq, poa_consensus(left_extensions),
+                             poa_consensus(right_extensions));
 }
 
 }  // namespace scaffolder
@@ -15,17 +15,16 @@
 #include <string>
 #include <utility>
 #include <unordered_map>
-#include <memory>
 
 #include "extension.h"
 #include "contig.h"
+#include "poa_engine.h"
 
 
 using std::vector;
 using std::string;
 using std::pair;
 using std::unordered_map;
-using std::shared_ptr;
 
 using seqan::Dna5String;
 using seqan::toCString;
@@ -84,6 +83,107 @@ void set_outer_margin(int margin);
 void set_min_coverage(int coverage);
 
 
+/**
+ * @brief Method sets the lookahead depth of the realignment.
+ * @details Reads which can not be locally realigned by a single base operation
+ * are resynchronised once the extension grows by depth bases, which allows
+ * reads to survive multi-base indels. Depth 0 disables the lookahead.
+ *
+ * @param depth the desired lookahead depth in bases
+ */
+void set_lookahead_depth(int depth);
+
+
+/**
+ * @brief Method sets the minimum gain rate of the realignment rounds.
+ * @details After each realignment round the extension bases it produced are
+ * divided by the aligner time spent on the preceding realignment. When the
+ * result drops below the given rate no further realignment is run for the
+ * contig. The policy depends on the machine load, so it is disabled by
+ * default; rate 0 disables it.
+ *
+ * @param rate minimum extension bases gained per second of aligner time
+ */
+void set_min_gain_rate(double rate);
+
+
+/**
+ * @brief Statistics of a single realignment round of a contig.
+ */
+struct RoundStats {
+    /**
+     * @brief extension bases gained on both sides in the round
+     */
+    uint32_t bases_gained;
+
+    /**
+     * @brief reads dropped in the round and sent to the external aligner
+     */
+    uint32_t dropped_reads;
+
+    /**
+     * @brief reads resynchronised in process in the round
+     */
+    uint32_t rescued_reads;
+
+    /**
+     * @brief wall time of the external realignment after the round, 0 if the
+     * aligner was not run
+     */
+    double aligner_seconds;
+};
+
+
+/**
+ * @brief Statistics of the realignment of all extended contigs.
+ */
+struct RealignStats {
+    /**
+     * @brief reads resynchronised by the lookahead during the majority vote
+     */
+    uint64_t lookahead_reads;
+
+    /**
+     * @brief reads recovered after the majority vote
+     */
+    uint64_t recovered_reads;
+
+    /**
+     * @brief realignment rounds which would have run the external aligner
+     * only for reads that were resynchronised in process
+     */
+    uint64_t saved_rounds;
+
+    /**
+     * @brief majority vote rounds over all contigs
+     */
+    uint64_t rounds;
+
+    /**
+     * @brief rounds followed by an external realignment
+     */
+    uint64_t aligner_rounds;
+
+    /**
+     * @brief total wall time of the external realignments
+     */
+    double aligner_seconds;
+
+    /**
+     * @brief contigs whose realignment was stopped by the gain rate policy
+     */
+    uint64_t policy_stops;
+};
+
+
+/**
+ * @brief Returns the realignment statistics of all extended contigs.
+ *
+ * @return RealignStats accumulated over all calls of extend_contig
+ */
+RealignStats get_realign_stats();
+
+
 /**
  * @brief Method finds substrings of reads which extend contig
  * on both ends.
@@ -102,14 +202,54 @@ void set_min_coverage(int coverage);
  * @param aln_records Records from SAM file
  * @param pleft_extensions Pointer to possible left end extensions
  * @param pright_extensions Pointer to possible right end extensions
+ * @param read_name_to_id Mapping from read name to integer ID.
  * @param contig_len Length of contig
  */
 void find_possible_extensions(const vector<BamAlignmentRecord>& aln_records,
-                              vector<string>* pleft_extensions,
-                              vector<string>* pright_extensions,
+                              ExtensionSet* pleft_extensions,
+                              ExtensionSet* pright_extensions,
+                              const unordered_map<string, uint32_t>&
+                              read_name_to_id,
                               uint64_t contig_len);
 
 
+/**
+ * @brief Computes the key of the extension settings.
+ * @details The key is a hash of the extension method, of the extension
+ * settings and of the vote mode, the same settings that are part of every
+ * extension_key.
+ *
+ * @param method description of the extension method and its own settings
+ *
+ * @return Key of the extension settings.
+ */
+string settings_key(const string& method);
+
+
+/**
+ * @brief Computes the key of a contig extension in the extension cache.
+ * @details The key is a hash of the contig sequence, of the alignments and
+ * the reads and qualities of all records which may extend a contig end, of
+ * the extension settings and of the vote mode. Records aligned away from
+ * the contig ends do not change the extension and are not part of the key.
+ *
+ * @param contig_seq the Sequence of the contig to be extended
+ * @param aln_records Alignment records from SAM file
+ * @param read_name_to_id Mapping from read name to integer ID.
+ * @param read_seqs Reads sequnces.
+ * @param read_quals Reads qualities, empty if the reads have no qualities.
+ * @param method description of the extension method and its own settings
+ *
+ * @return Key of the extension.
+ */
+string extension_key(const Dna5String& contig_seq,
+                     const vector<BamAlignmentRecord>& aln_records,
+                     const unordered_map<string, uint32_t>& read_name_to_id,
+                     const StringSet<Dna5String>& read_seqs,
+                     const StringSet<CharString>& read_quals,
+                     const string& method);
+
+
 /**
  * @brief Method finds contig extension using majority vote on each
  * position of possible extensions while coverage >= k
@@ -118,7 +258,7 @@ void find_possible_extensions(const vector<BamAlignmentRecord>& aln_records,
  * @param extensions Possible contig extensions strings
  * @return Contig extension.
  */
-string get_extension_mv_simple(const vector<string>& extensions);
+string get_extension_mv_simple(const ExtensionSet& extensions);
 
 
 /**
@@ -134,11 +274,71 @@ string get_extension_mv_simple(const vector<string>& extensions);
  * base by majority vote, but only reads withcorrect base at current
  * position are considered eligible for counting.
  *
- * @param extensions Possible contig extensions.
+ * Reads dropped by the local realignment are afterwards aligned in process
+ * against the produced extension, see recover_dropped_reads.
+ *
+ * @param extensions Possible contig extensions, current positions are
+ * advanced and reads that cannot be realigned are dropped.
+ * @param precovered optional pointer to the number of dropped reads which were
+ * recovered in process
  * @return Resulting contig extension.
  */
-string get_extension_mv_realign(const vector<shared_ptr<Extension>>&
-                                extensions);
+string get_extension_mv_realign(ExtensionSet& extensions,
+                                uint32_t *precovered = nullptr);
+
+
+/**
+ * @brief A read dropped during the majority vote.
+ */
+struct DroppedRead {
+    /**
+     * @brief index of the read in the extension set
+     */
+    uint32_t idx;
+
+    /**
+     * @brief index of the extension base the read was dropped at
+     */
+    uint32_t column;
+};
+
+
+/**
+ * @brief Method resynchronises a dropped read with the extension.
+ * @details The bases of the read from its current position are aligned to the
+ * extension bases from the drop column to the end of the extension. If the
+ * edit distance is at most max_errors and the read has bases left, the read is
+ * restored at the position following the aligned bases.
+ *
+ * @param extensions Possible contig extensions
+ * @param extension extension produced by the majority vote so far
+ * @param read the dropped read
+ * @param max_errors maximum accepted edit distance
+ * @return True if the read was restored, false otherwise.
+ */
+bool resync_read(ExtensionSet& extensions, const string& extension,
+                 const DroppedRead& read, uint32_t max_errors);
+
+
+/**
+ * @brief Method reactivates dropped reads which align to the extension.
+ * @details For each dropped read the bases from its current position are
+ * aligned to the extension bases produced since the read was dropped, using a
+ * bit-parallel edit distance restricted to a band of the allowed number of
+ * errors. If the alignment is good enough, the read is restored with its
+ * current position set right after the aligned bases. Reads dropped too close
+ * to the end of the extension are skipped as their alignment end is
+ * ambiguous. Reads which can not be
+ * recovered stay dropped and are realigned by the external aligner.
+ *
+ * @param extensions Possible contig extensions
+ * @param extension extension produced by the majority vote
+ * @param dropped reads dropped during the majority vote
+ * @return Number of recovered reads.
+ */
+uint32_t recover_dropped_reads(ExtensionSet& extensions,
+                               const string& extension,
+                               const vector<DroppedRead>& dropped);
 
 
 /**
@@ -149,13 +349,19 @@ string get_extension_mv_realign(const vector<shared_ptr<Extension>>&
  * globally realigned and new possible extensions of already extended
  * contig are found. If the coverage of left and right possible
  * extensions are both below the minimum coverage, contig cannot be
- * extended anymore and process is stopped.
+ * extended anymore and process is stopped. The process is also stopped
+ * when a round gains too few bases for the aligner time it cost, see
+ * set_min_gain_rate.
  *
  * @param contig_seq the Sequence of the contig to be extended
  * @param aln_records Alignment records from SAM file
  * @param read_name_to_id Mapping from read name to integer ID.
  * @param read_ids Reads names / string IDs.
  * @param read_seqs Reads sequnces.
+ * @param read_quals Reads qualities, empty if the reads have no qualities.
+ * @param worker_id Index of the calling worker, contigs extended concurrently
+ * must use different indices as it selects the temporary files.
+ * @param pround_stats optional pointer to the statistics of each round
  *
  * @return Contig extended on both sides
  */
@@ -163,7 +369,45 @@ Contig* extend_contig(Dna5String& contig_seq,
                       const vector<BamAlignmentRecord>& aln_records,
                       const unordered_map<string, uint32_t>& read_name_to_id,
                       const StringSet<CharString>& read_ids,
-                      const StringSet<Dna5String>& read_seqs);
+                      const StringSet<Dna5String>& read_seqs,
+                      const StringSet<CharString>& read_quals,
+                      uint32_t worker_id,
+                      vector<RoundStats>* pround_stats = nullptr);
+
+
+/**
+ * @brief Method finds the extension sequences used as POA input.
+ * @details Possible extensions of both contig ends are found and trimmed to
+ * the maximum extension length. Left extensions are stored in reverse, i.e.
+ * starting from the contig end and moving left.
+ *
+ * @param contig_seq the Sequence of the contig to be extended
+ * @param aln_records Alignment records from SAM file
+ * @param read_name_to_id Mapping from read name to integer ID.
+ * @param pleft_extensions Pointer to left extension sequences
+ * @param pright_extensions Pointer to right extension sequences
+ */
+void find_poa_extensions(const Dna5String& contig_seq,
+                         const vector<BamAlignmentRecord>& aln_records,
+                         const unordered_map<string, uint32_t>&
+                         read_name_to_id,
+                         vector<string>* pleft_extensions,
+                         vector<string>* pright_extensions);
+
+
+/**
+ * @brief Method creates an extended contig from POA consensus sequences.
+ *
+ * @param contig_seq the Sequence of the contig to be extended
+ * @param left_consensus consensus of the left extensions as returned by POA,
+ * i.e. in reverse
+ * @param right_consensus consensus of the right extensions
+ *
+ * @return Contig extended on both sides.
+ */
+Contig* create_contig_poa(const Dna5String& contig_seq,
+                          string left_consensus,
+                          string right_consensus);
 
 
 /**
@@ -180,13 +424,16 @@ Contig* extend_contig(Dna5String& contig_seq,
  * @param contig_seq the Sequence of the contig to be extended
  * @param aln_records Alignment records from SAM file
  * @param read_name_to_id Mapping from read name to integer ID.
+ * @param backend POA implementation used to compute the consensus
  *
  * @return Contig extended on both sides.
  */
 Contig* extend_contig_poa(const Dna5String& contig_seq,
                           const vector<BamAlignmentRecord>& aln_records,
                           const unordered_map<string, uint32_t>&
-                          read_name_to_id);
+                          read_name_to_id,
+                          poa_backend::PoaBackend backend =
+                          poa_backend::CppPoa);
 
 
 }  // namespace scaffolder
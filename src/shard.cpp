@@ -0,0 +1,209 @@
+/**
+ * @file shard.cpp
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the shard namespace.
+ * @details Implementation file for the shard namespace. It provides functions
+ * used to partition the draft genome into shards and to store and load the
+ * extended contigs of a shard.
+ */
+#include <seqan/sequence.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include "shard.h"
+#include "utility.h"
+
+
+using std::string;
+using std::vector;
+using std::sort;
+using std::min_element;
+
+using seqan::length;
+
+
+namespace shard {
+
+
+// RAII wrapper closing the file on scope exit
+struct FileHandle {
+    FILE *file;
+    explicit FileHandle(FILE *file): file(file) {}
+    ~FileHandle() { if (file != nullptr) fclose(file); }
+};
+
+
+void write_bytes(FILE *file, const void *data, size_t len,
+                 const char *filename) {
+    if (len > 0 && fwrite(data, 1, len, file) != len) {
+        utility::exit_with_message("Could not write to file %s", filename);
+    }
+}
+
+
+void write_u32(FILE *file, uint32_t value, const char *filename) {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = (value >> (8 * i)) & 0xFF;
+    }
+    write_bytes(file, bytes, 4, filename);
+}
+
+
+void write_u64(FILE *file, uint64_t value, const char *filename) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = (value >> (8 * i)) & 0xFF;
+    }
+    write_bytes(file, bytes, 8, filename);
+}
+
+
+void read_bytes(FILE *file, void *data, size_t len, const char *filename) {
+    if (len > 0 && fread(data, 1, len, file) != len) {
+        utility::exit_with_message("Truncated shard file %s", filename);
+    }
+}
+
+
+uint32_t read_u32(FILE *file, const char *filename) {
+    unsigned char bytes[4];
+    read_bytes(file, bytes, 4, filename);
+
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+
+uint64_t read_u64(FILE *file, const char *filename) {
+    unsigned char bytes[8];
+    read_bytes(file, bytes, 8, filename);
+
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+
+vector<uint32_t> partition_contigs(const StringSet<Dna5String>& contig_seqs,
+                                   uint32_t num_shards) {
+    uint32_t num_contigs = length(contig_seqs);
+
+    vector<uint32_t> order(num_contigs);
+    std::iota(order.begin(), order.end(), 0);
+
+    // longest contigs first, ties broken by draft order
+    sort(order.begin(), order.end(), [&] (uint32_t a, uint32_t b) {
+        if (length(contig_seqs[a]) != length(contig_seqs[b])) {
+            return length(contig_seqs[a]) > length(contig_seqs[b]);
+        }
+        return a < b;
+    });
+
+    vector<uint64_t> shard_sizes(num_shards, 0);
+    vector<uint32_t> assignment(num_contigs, 0);
+
+    for (auto contig_idx : order) {
+        auto lightest = min_element(shard_sizes.begin(), shard_sizes.end());
+        assignment[contig_idx] = lightest - shard_sizes.begin();
+        *lightest += length(contig_seqs[contig_idx]);
+    }
+
+    return assignment;
+}
+
+
+void write_shard(const char *filename, uint32_t shard_idx,
+                 uint32_t num_shards, const vector<IndexedContig>& contigs) {
+    FileHandle handle(fopen(filename, "wb"));
+    if (handle.file == nullptr) {
+        utility::exit_with_message("Could not open file %s", filename);
+    }
+
+    FILE *file = handle.file;
+
+    write_bytes(file, SHARD_MAGIC, strlen(SHARD_MAGIC), filename);
+    write_u32(file, SHARD_FORMAT_VERSION, filename);
+    write_u32(file, shard_idx, filename);
+    write_u32(file, num_shards, filename);
+    write_u32(file, contigs.size(), filename);
+
+    for (auto const& indexed_contig : contigs) {
+        Contig *contig = indexed_contig.second;
+
+        write_u32(file, indexed_contig.first, filename);
+        write_u32(file, contig->total_ext_left(), filename);
+        write_u32(file, contig->total_ext_right(), filename);
+
+        string id = utility::CharString_to_string(contig->id());
+        write_u32(file, id.length(), filename);
+        write_bytes(file, id.data(), id.length(), filename);
+
+        string seq = utility::Dna5String_to_string(contig->seq());
+        write_u64(file, seq.length(), filename);
+        write_bytes(file, seq.data(), seq.length(), filename);
+    }
+}
+
+
+void read_shard(const char *filename, uint32_t num_shards,
+                vector<IndexedContig>* pcontigs) {
+    auto& contigs = *pcontigs;
+
+    FileHandle handle(fopen(filename, "rb"));
+    if (handle.file == nullptr) {
+        utility::exit_with_message("Could not open file %s", filename);
+    }
+
+    FILE *file = handle.file;
+
+    char magic[sizeof(SHARD_MAGIC) - 1];
+    read_bytes(file, magic, sizeof(magic), filename);
+    if (memcmp(magic, SHARD_MAGIC, sizeof(magic)) != 0) {
+        utility::exit_with_message("%s is not a shard file", filename);
+    }
+
+    uint32_t version = read_u32(file, filename);
+    if (version != SHARD_FORMAT_VERSION) {
+        utility::exit_with_message("Unsupported shard format version %u in %s",
+                                   version, filename);
+    }
+
+    read_u32(file, filename);  // shard index
+    if (read_u32(file, filename) != num_shards) {
+        utility::exit_with_message("Shard count mismatch in %s", filename);
+    }
+
+    uint32_t num_contigs = read_u32(file, filename);
+
+    for (uint32_t i = 0; i < num_contigs; ++i) {
+        uint32_t contig_idx = read_u32(file, filename);
+        int ext_left = static_cast<int32_t>(read_u32(file, filename));
+        int ext_right = static_cast<int32_t>(read_u32(file, filename));
+
+        string id(read_u32(file, filename), '\0');
+        read_bytes(file, &id[0], id.length(), filename);
+
+        string seq(read_u64(file, filename), '\0');
+        read_bytes(file, &seq[0], seq.length(), filename);
+
+        Dna5String contig_seq = seq;
+        Contig *contig = new Contig(contig_seq, ext_left, ext_right);
+        contig->set_id(id);
+
+        contigs.emplace_back(contig_idx, contig);
+    }
+}
+
+
+}  // namespace shard
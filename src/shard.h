@@ -0,0 +1,116 @@
+/**
+ * @file shard.h
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the shard namespace.
+ * @details Header file for the shard namespace. It provides functions used to
+ * partition the draft genome into shards and to store and load the extended
+ * contigs of a shard.
+ *
+ * Shard files use the following binary layout, all integers are unsigned
+ * unless stated otherwise and are stored in little-endian byte order:
+ *
+ * | Field          | Type      | Description                               |
+ * | :------------- | :-------- | :---------------------------------------- |
+ * | magic          | char[8]   | the characters "EAGLSHRD"                 |
+ * | version        | uint32    | format version, currently 1               |
+ * | shard_idx      | uint32    | index of the shard in range [0, shards)   |
+ * | num_shards     | uint32    | total number of shards                    |
+ * | num_contigs    | uint32    | number of contig records that follow      |
+ *
+ * Each contig record has the following layout:
+ *
+ * | Field          | Type      | Description                               |
+ * | :------------- | :-------- | :---------------------------------------- |
+ * | contig_idx     | uint32    | index of the contig in the draft genome   |
+ * | ext_left       | int32     | length of the left extension              |
+ * | ext_right      | int32     | length of the right extension             |
+ * | id_len         | uint32    | length of the contig id                   |
+ * | id             | char[]    | contig id, not null terminated            |
+ * | seq_len        | uint64    | length of the extended contig sequence    |
+ * | seq            | char[]    | extended contig bases, one ASCII per base |
+ */
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <seqan/sequence.h>
+#include <vector>
+#include <utility>
+
+#include "contig.h"
+
+
+using std::vector;
+using std::pair;
+
+using seqan::StringSet;
+using seqan::Dna5String;
+
+
+/**
+ * @brief Magic bytes at the beginning of every shard file
+ */
+#define SHARD_MAGIC "EAGLSHRD"
+
+/**
+ * @brief Current version of the shard file format
+ */
+#define SHARD_FORMAT_VERSION 1
+
+
+/**
+ * @brief Extended contig paired with its index in the draft genome.
+ */
+typedef pair<uint32_t, Contig*> IndexedContig;
+
+
+/**
+ * @brief Namespace for draft genome sharding.
+ */
+namespace shard {
+
+
+/**
+ * @brief Assigns each contig of the draft genome to a shard.
+ * @details Contigs are assigned longest first to the shard with the smallest
+ * total length. The assignment depends only on the contig lengths, so every
+ * process computes the same partition.
+ *
+ * @param contig_seqs contigs of the draft genome
+ * @param num_shards number of shards
+ *
+ * @return shard index of every contig
+ */
+vector<uint32_t> partition_contigs(const StringSet<Dna5String>& contig_seqs,
+                                   uint32_t num_shards);
+
+
+/**
+ * @brief Writes the extended contigs of a shard to a shard file.
+ *
+ * @param filename path to the output file
+ * @param shard_idx index of the shard
+ * @param num_shards total number of shards
+ * @param contigs extended contigs of the shard
+ */
+void write_shard(const char *filename, uint32_t shard_idx,
+                 uint32_t num_shards, const vector<IndexedContig>& contigs);
+
+
+/**
+ * @brief Reads the extended contigs stored in a shard file.
+ * @details The contigs are appended to the given vector, the caller takes
+ * ownership of the created Contig objects.
+ *
+ * @param filename path to the shard file
+ * @param num_shards expected total number of shards
+ * @param pcontigs pointer to the vector of extended contigs
+ */
+void read_shard(const char *filename, uint32_t num_shards,
+                vector<IndexedContig>* pcontigs);
+
+
+}  // namespace shard
+
+
+#endif  // SHARD_H
@@ -0,0 +1,92 @@
+/**
+ * @file thread_pool.cpp
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the ThreadPool class.
+ * @details Implementation file for the ThreadPool class. A fixed number of
+ * worker threads consume tasks from a shared queue.
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "thread_pool.h"
+
+
+using std::max;
+using std::mutex;
+using std::unique_lock;
+using std::lock_guard;
+
+
+ThreadPool::ThreadPool(uint32_t num_threads): pending_(0), stopping_(false) {
+    num_threads = max(1u, num_threads);
+
+    for (uint32_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+
+ThreadPool::~ThreadPool() {
+    wait();
+
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    task_cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+
+void ThreadPool::submit(pool_task task) {
+    {
+        lock_guard<mutex> lock(mutex_);
+        tasks_.emplace(std::move(task));
+        ++pending_;
+    }
+
+    task_cv_.notify_one();
+}
+
+
+void ThreadPool::wait() {
+    unique_lock<mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return pending_ == 0; });
+}
+
+
+void ThreadPool::worker_loop(uint32_t worker_id) {
+    while (true) {
+        pool_task task;
+
+        {
+            unique_lock<mutex> lock(mutex_);
+            task_cv_.wait(lock, [this] {
+                return stopping_ || !tasks_.empty();
+            });
+
+            if (tasks_.empty()) {
+                // stopping and nothing left to do
+                return;
+            }
+
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+
+        task(worker_id);
+
+        {
+            lock_guard<mutex> lock(mutex_);
+            if (--pending_ == 0) {
+                done_cv_.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * @file thread_pool.h
+ * @copyright Marko Culinovic <marko.culinovic@gmail.com>
+ * @copyright Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the ThreadPool class.
+ * @details Header file for the ThreadPool class. A fixed number of worker
+ * threads consume tasks from a shared queue, each task receives the index of
+ * the worker executing it so that callers can keep per-worker state.
+ */
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+
+using std::vector;
+using std::queue;
+
+
+/**
+ * @brief Type of a task executed by the ThreadPool, the argument is the index
+ * of the worker thread in range [0, num_threads)
+ */
+typedef std::function<void(uint32_t)> pool_task;
+
+
+/**
+ * @brief Fixed size pool of worker threads.
+ * @details Tasks are executed in the order of submission by the first
+ * available worker. The wait method blocks until every submitted task has
+ * been executed, after which the pool can be reused for a new batch of tasks.
+ */
+class ThreadPool {
+ public:
+    /**
+     * @brief ThreadPool class constructor.
+     * @details Starts the worker threads, at least one worker is always
+     * created.
+     *
+     * @param num_threads the number of worker threads
+     */
+    explicit ThreadPool(uint32_t num_threads);
+
+
+    /**
+     * @brief ThreadPool class destructor.
+     * @details Waits for all pending tasks and joins the worker threads.
+     */
+    ~ThreadPool();
+
+
+    /**
+     * @brief Adds a task to the queue of pending tasks.
+     *
+     * @param task function to be called by one of the workers
+     */
+    void submit(pool_task task);
+
+
+    /**
+     * @brief Blocks until all submitted tasks have been executed.
+     */
+    void wait();
+
+
+    /**
+     * @brief Getter for the number of worker threads.
+     * @return Number of worker threads.
+     */
+    uint32_t size() const { return workers_.size(); }
+
+ private:
+    /**
+     * @brief Main loop of a worker thread.
+     *
+     * @param worker_id index of the worker
+     */
+    void worker_loop(uint32_t worker_id);
+
+    // worker threads
+    vector<std::thread> workers_;
+    // tasks waiting for a free worker
+    queue<pool_task> tasks_;
+
+    // guards the task queue and the counters below
+    std::mutex mutex_;
+    // signaled when a task is submitted or the pool is stopped
+    std::condition_variable task_cv_;
+    // signaled when the last pending task is finished
+    std::condition_variable done_cv_;
+
+    // number of tasks submitted but not yet finished
+    uint32_t pending_;
+    // set by the destructor to stop the workers
+    bool stopping_;
+};
+
+
+#endif  // THREAD_POOL_H
@@ -10,6 +10,7 @@
 #include <seqan/seq_io.h>
 #include <seqan/bam_io.h>
 #include <iostream>
+#include <fstream>
 #include <exception>
 #include <cstdio>
 #include <cstdlib>
@@ -19,6 +20,8 @@
 #include <algorithm>
 #include <regex>
 #include <cstdarg>
+#include <thread>
+#include <unistd.h>
 
 #include "utility.h"
 
@@ -59,13 +62,13 @@ unsigned int hardware_concurrency = max(
     1u, std::thread::hardware_concurrency());
 
 
-char command_buffer[COMMAND_BUFFER_SIZE] = { 0 };
+thread_local char command_buffer[COMMAND_BUFFER_SIZE] = { 0 };
 
 
-char error_buffer[ERROR_BUFFER_SIZE] = { 0 };
+thread_local char error_buffer[ERROR_BUFFER_SIZE] = { 0 };
 
 
-char seq_id_buffer[SEQ_ID_BUFFER_SIZE] = { 0 };
+thread_local char seq_id_buffer[SEQ_ID_BUFFER_SIZE] = { 0 };
 
 
 unsigned int get_concurrency_level() {
@@ -102,6 +105,44 @@ void read_fasta(StringSet<CharString>* pids, StringSet<Dna5String>* pseqs,
 }
 
 
+void read_sequences(StringSet<CharString>* pids,
+                    StringSet<Dna5String>* pseqs,
+                    StringSet<CharString>* pquals, const char *filename) {
+    auto& ids = *pids;
+    auto& seqs = *pseqs;
+    auto& quals = *pquals;
+
+    // opening input file, the format is detected from the file
+    SeqFileIn input_file;
+    if (!open(input_file, filename)) {
+        exit_with_message("Could not open file %s", filename);
+    }
+
+    // read all records in file, FASTA records have empty qualities
+    try {
+        readRecords(ids, seqs, quals, input_file);
+    } catch(exception const& e) {
+        exit_with_message(e.what());
+    }
+}
+
+
+bool has_qualities(const StringSet<Dna5String>& seqs,
+                   const StringSet<CharString>& quals) {
+    if (length(quals) != length(seqs) || length(seqs) == 0) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < length(seqs); ++i) {
+        if (length(quals[i]) != length(seqs[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
 void write_fasta(const CharString &id, const Dna5String &seq,
                  const char* filename) {
     // opening output file
@@ -139,6 +180,97 @@ void write_fasta(const StringSet<CharString>& ids,
 }
 
 
+void write_fasta(std::ostream& out, const string& id,
+                 const vector<SequenceSlice>& slices) {
+    out << '>' << id << '\n';
+
+    string line;
+    line.reserve(FASTA_LINE_LENGTH);
+
+    auto push_base = [&out, &line](char base) {
+        line.push_back(base);
+        if (line.length() == FASTA_LINE_LENGTH) {
+            out << line << '\n';
+            line.clear();
+        }
+    };
+
+    for (auto const& slice : slices) {
+        const Dna5String& seq = *slice.seq;
+
+        if (slice.reverse) {
+            for (uint32_t i = slice.end; i > slice.begin; --i) {
+                push_base(bases::complement(static_cast<char>(seq[i - 1])));
+            }
+        } else {
+            for (uint32_t i = slice.begin; i < slice.end; ++i) {
+                push_base(static_cast<char>(seq[i]));
+            }
+        }
+    }
+
+    if (!line.empty()) {
+        out << line << '\n';
+    }
+}
+
+
+string slice_to_string(const SequenceSlice& slice, uint32_t begin,
+                       uint32_t end) {
+    const Dna5String& seq = *slice.seq;
+
+    string result;
+    result.reserve(end - begin);
+
+    for (uint32_t i = begin; i < end; ++i) {
+        if (slice.reverse) {
+            result.push_back(bases::complement(
+                static_cast<char>(seq[slice.end - 1 - i])));
+        } else {
+            result.push_back(static_cast<char>(seq[slice.begin + i]));
+        }
+    }
+
+    return result;
+}
+
+
+void write_fasta(const string& id, const vector<SequenceSlice>& slices,
+                 const char *filename) {
+    std::ofstream out(filename);
+    if (!out) {
+        exit_with_message("Could not open file %s", filename);
+    }
+
+    write_fasta(out, id, slices);
+
+    if (!out) {
+        exit_with_message("Could not write file %s", filename);
+    }
+}
+
+
+void write_fastq(const StringSet<CharString>& ids,
+                 const StringSet<Dna5String>& seqs,
+                 const StringSet<CharString>& quals,
+                 const char *filename) {
+    // opening output file, the format is selected by the file extension
+    SeqFileOut out_file;
+    if (!open(out_file, filename)) {
+        exit_with_message("Could not open file %s", filename);
+    }
+
+    // attempt write
+    for (uint32_t i = 0; i < length(ids); ++i) {
+        try {
+            writeRecord(out_file, ids[i], seqs[i], quals[i]);
+        } catch(exception const& e) {
+            exit_with_message(e.what());
+        }
+    }
+}
+
+
 void read_sam(BamHeader* pheader, vector<BamAlignmentRecord>* precords,
               const char* filename) {
     auto& header = *pheader;
@@ -242,26 +374,16 @@ void execute_command(const char *format, ...) {
 
 
 int base_to_idx(char base) {
-    switch (base) {
-        case 'A': return 0;
-        case 'T': return 1;
-        case 'G': return 2;
-        case 'C': return 3;
-    }
-
-    throw invalid_argument("Illegal base character.");
+    return bases::encode(base);
 }
 
 
 char idx_to_base(int idx) {
-    switch (idx) {
-        case 0: return 'A';
-        case 1: return 'T';
-        case 2: return 'G';
-        case 3: return 'C';
+    if (idx < 0 || idx >= NUM_BASE_CODES) {
+        throw invalid_argument("Illegal base ID.");
     }
 
-    throw invalid_argument("Illegal base ID.");
+    return bases::CODE_BASES[idx];
 }
 
 
@@ -319,19 +441,8 @@ string reverse_complement(const Dna5String& seq) {
     string tmp = Dna5String_to_string(seq);
     reverse(tmp.begin(), tmp.end());
 
-    auto complement = [](char base) -> char {
-        switch (base) {
-            case 'A': return 'T';
-            case 'T': return 'A';
-            case 'C': return 'G';
-            case 'G': return 'C';
-            default: throw_exception<runtime_error>("Illegal base");
-        }
-        return 'N';  // unknown base
-    };
-
     for (size_t i = 0; i < tmp.length(); ++i) {
-        tmp[i] = complement(tmp[i]);
+        tmp[i] = bases::complement(tmp[i]);
     }
 
     return tmp;
@@ -350,6 +461,23 @@ string create_seq_id(const char *format, ...) {
 }
 
 
+string absolute_path(const char *path) {
+    if (path[0] == '/') {
+        return string(path);
+    }
+
+    char *cwd = getcwd(nullptr, 0);
+    if (cwd == nullptr) {
+        exit_with_message("Could not determine the working directory");
+    }
+
+    string result = string(cwd) + "/" + path;
+    free(cwd);
+
+    return result;
+}
+
+
 bool is_command_available(const char* command) {
     snprintf(command_buffer, COMMAND_BUFFER_SIZE, "type \"%s\" >/dev/null 2>&1",
              command);
@@ -26,8 +26,11 @@
 #include <seqan/bam_io.h>
 #include <vector>
 #include <string>
+#include <ostream>
 #include <unordered_map>
 
+#include "base_tables.h"
+
 
 using std::vector;
 using std::string;
@@ -48,10 +51,27 @@ using seqan::BamAlignmentRecord;
  */
 #define UNMAPPED 0x4
 
+/**
+ * @brief SAM format flag of a query from the complement strand of the
+ * reference genome
+ */
+#define COMPLEMENT 0x10
+
+/**
+ * @brief SAM format secondary alignment flag
+ */
+#define SECONDARY_ALIGNMENT 0x100
+
+/**
+ * @brief SAM format flags of a non-primary alignment, secondary or
+ * supplementary
+ */
+#define SECONDARY_LINE 0x900
+
 /**
  * @brief The size of the shell command buffer in bytes
  */
-#define COMMAND_BUFFER_SIZE 256
+#define COMMAND_BUFFER_SIZE 4096
 
 
 /**
@@ -63,7 +83,42 @@ using seqan::BamAlignmentRecord;
 /**
  * @brief The size of the sequence name buffer in bytes
  */
-#define SEQ_ID_BUFFER_SIZE 160
+#define SEQ_ID_BUFFER_SIZE 1024
+
+
+/**
+ * @brief Number of bases per line of written FASTA records
+ */
+#define FASTA_LINE_LENGTH 70
+
+
+/**
+ * @brief Slice of a sequence stored elsewhere.
+ * @details A list of slices describes the concatenation of the slices, which
+ * can be written without copying the bases into a single sequence.
+ */
+struct SequenceSlice {
+    /**
+     * @brief sequence the slice refers to, must outlive the slice
+     */
+    const Dna5String *seq;
+
+    /**
+     * @brief index of the first base of the slice
+     */
+    uint32_t begin;
+
+    /**
+     * @brief index one past the last base of the slice
+     */
+    uint32_t end;
+
+    /**
+     * @brief true if the slice is read as the reverse complement of
+     * [begin, end)
+     */
+    bool reverse;
+};
 
 
 /**
@@ -76,21 +131,22 @@ namespace utility {
 
 
 /**
- * @brief Buffer to hold shell command strings
+ * @brief Buffer to hold shell command strings, one per thread
  */
-extern char command_buffer[COMMAND_BUFFER_SIZE];
+extern thread_local char command_buffer[COMMAND_BUFFER_SIZE];
 
 
 /**
- * @brief Buffer to hold a description string when an error occurs
+ * @brief Buffer to hold a description string when an error occurs, one per
+ * thread
  */
-extern char error_buffer[ERROR_BUFFER_SIZE];
+extern thread_local char error_buffer[ERROR_BUFFER_SIZE];
 
 
 /**
- * @brief Buffer used to build the name of a sequence
+ * @brief Buffer used to build the name of a sequence, one per thread
  */
-extern char seq_id_buffer[SEQ_ID_BUFFER_SIZE];
+extern thread_local char seq_id_buffer[SEQ_ID_BUFFER_SIZE];
 
 
 /**
@@ -125,6 +181,35 @@ void read_fasta(StringSet<CharString>* pids,
                 char *ont_reads_filename);
 
 
+/**
+ * @brief Reads a FASTA or FASTQ file
+ * @details Reads sequences data from a FASTA or FASTQ file, the format is
+ * detected from the file. Ids, sequences and qualities are stored in three
+ * sets, qualities of FASTA records are empty.
+ *
+ * @param pids pointer to the set of ids
+ * @param pseqs pointer to the set of sequences
+ * @param pquals pointer to the set of ASCII encoded Phred qualities
+ * @param filename path to the input file
+ */
+void read_sequences(StringSet<CharString>* pids,
+                    StringSet<Dna5String>* pseqs,
+                    StringSet<CharString>* pquals,
+                    const char *filename);
+
+
+/**
+ * @brief Checks if every sequence has qualities
+ *
+ * @param seqs collection of sequences
+ * @param quals collection of qualities of the sequences
+ *
+ * @return True if every sequence has one quality per base, false otherwise.
+ */
+bool has_qualities(const StringSet<Dna5String>& seqs,
+                   const StringSet<CharString>& quals);
+
+
 /**
  * @brief Write a sequence to file
  * @details Writes a single sequence to a FASTA file.
@@ -151,6 +236,61 @@ void write_fasta(const StringSet<CharString>& ids,
                 const char *filename);
 
 
+/**
+ * @brief Writes a sequence given as slices to a stream
+ * @details Writes a single FASTA record whose bases are the concatenation of
+ * the given slices. Bases are streamed one line at a time, the concatenated
+ * sequence is never built.
+ *
+ * @param out output stream
+ * @param id string ID of the sequence
+ * @param slices slices of the sequence in order
+ */
+void write_fasta(std::ostream& out, const string& id,
+                 const vector<SequenceSlice>& slices);
+
+
+/**
+ * @brief Copies a part of a slice
+ *
+ * @param slice slice of a sequence
+ * @param begin index of the first base, relative to the slice
+ * @param end index one past the last base, relative to the slice
+ * @return Bases of the part in the orientation of the slice.
+ */
+string slice_to_string(const SequenceSlice& slice, uint32_t begin,
+                       uint32_t end);
+
+
+/**
+ * @brief Writes a sequence given as slices to file
+ * @details Writes a single FASTA record whose bases are the concatenation of
+ * the given slices, see the stream overload.
+ *
+ * @param id string ID of the sequence
+ * @param slices slices of the sequence in order
+ * @param filename path to the output file
+ */
+void write_fasta(const string& id, const vector<SequenceSlice>& slices,
+                 const char *filename);
+
+
+/**
+ * @brief Writes a set of sequences with qualities to file
+ * @details Writes multiple sequences to a FASTQ file. String ids, sequence
+ * contents and qualities at the same index form one FASTQ entry.
+ *
+ * @param ids collection of the string ids of the sequences
+ * @param seqs collection of the bases of the sequences
+ * @param quals collection of the ASCII encoded Phred qualities
+ * @param filename path to the output file, should have a FASTQ extension
+ */
+void write_fastq(const StringSet<CharString>& ids,
+                 const StringSet<Dna5String>& seqs,
+                 const StringSet<CharString>& quals,
+                 const char *filename);
+
+
 /**
  * @brief Read a SAM file
  * @details Reads alignment data from the given SAM file and stores the sequence
@@ -193,12 +333,13 @@ void execute_command(const char *format, ...);
 /**
  * @brief Char base to int id
  * @details Converts a nucleotide character to its corresponding integer id. the
- * mapping used is {'A': 0, 'T': 1, 'G': 2, 'C': 3}.
+ * mapping used is {'A': 0, 'T': 1, 'G': 2, 'C': 3}, lower case bases are
+ * mapped the same way while N, IUPAC codes and any other character are mapped
+ * to BASE_N_IDX.
  *
  * @param base nucleotide base
  *
  * @return integer base id
- * @throw std::invalid_argument when the base is not a valid nucleotide
  */
 int base_to_idx(char base);
 
@@ -206,12 +347,12 @@ int base_to_idx(char base);
 /**
  * @brief Base id to char base
  * @details Converts the given id to the correspondent nucleotide. The mapping
- * used is {0: 'A', 1: 'T', 2: 'G', 3: 'C'}.
+ * used is {0: 'A', 1: 'T', 2: 'G', 3: 'C', 4: 'N'}.
  *
  * @param idx integer base id
  *
  * @return nucleotide character
- * @throw std::invalid_argument when idx < 0 or idx > 3
+ * @throw std::invalid_argument when idx < 0 or idx > BASE_N_IDX
  */
 char idx_to_base(int idx);
 
@@ -293,6 +434,8 @@ int contributes_to_contig_len(char c);
 /**
  * @brief Method creates reverse complement from string
  * given as parameter
+ * @details IUPAC codes are complemented to their IUPAC complement, any other
+ * character which is not a nucleotide is complemented to N.
  *
  * @param seq String that needs to be reverse complemented.
  * @return Reverse complement of string given as parameter.
@@ -310,6 +453,17 @@ string reverse_complement(const Dna5String& seq);
 string create_seq_id(const char *format, ...);
 
 
+/**
+ * @brief Converts the given path to an absolute path.
+ * @details Relative paths are prefixed with the current working directory,
+ * absolute paths are returned unchanged. The path does not need to exist.
+ *
+ * @param path relative or absolute path
+ * @return absolute path
+ */
+string absolute_path(const char *path);
+
+
 /**
  * @brief Checks if the given command is available through the system shell.
  *
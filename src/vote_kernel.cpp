@@ -0,0 +1,296 @@
+/**
+ * @file vote_kernel.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the column vote kernel.
+ * @details Implementation file for the column vote kernel. Each kernel
+ * computes a joint histogram of (current, next) base code pairs, from which
+ * both the current column histogram and the next column histograms are
+ * derived.
+ */
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "vote_kernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define VOTE_KERNEL_X86
+#endif
+
+
+/**
+ * @brief Number of different base codes
+ */
+#define NUM_CODES 6
+
+/**
+ * @brief Width in bytes of the widest supported vector register
+ */
+#define VECTOR_WIDTH 32
+
+
+namespace bases {
+
+
+// counts of the current base codes and of base code pairs
+struct PairHistogram {
+    uint32_t current[NUM_CODES];
+    uint32_t pairs[NUM_BASES][NUM_BASES];
+};
+
+
+typedef void (*kernel_function)(const uint8_t*, const uint8_t*, uint32_t,
+                                PairHistogram*);
+
+
+void count_pairs_scalar(const uint8_t *current, const uint8_t *next,
+                        uint32_t size, PairHistogram *histogram) {
+    uint32_t joint[NUM_CODES][NUM_CODES];
+    memset(joint, 0, sizeof(joint));
+
+    for (uint32_t i = 0; i < size; ++i) {
+        joint[current[i]][next[i]]++;
+    }
+
+    for (int c = 0; c < NUM_CODES; ++c) {
+        for (int n = 0; n < NUM_CODES; ++n) {
+            histogram->current[c] += joint[c][n];
+        }
+    }
+
+    for (int c = 0; c < NUM_BASES; ++c) {
+        for (int n = 0; n < NUM_BASES; ++n) {
+            histogram->pairs[c][n] += joint[c][n];
+        }
+    }
+}
+
+
+#ifdef VOTE_KERNEL_X86
+
+__attribute__((target("sse4.2,popcnt")))
+void count_pairs_sse42(const uint8_t *current, const uint8_t *next,
+                       uint32_t size, PairHistogram *histogram) {
+    __m128i codes[NUM_BASES];
+    for (int b = 0; b < NUM_BASES; ++b) {
+        codes[b] = _mm_set1_epi8(b);
+    }
+
+    for (uint32_t i = 0; i < size; i += 16) {
+        __m128i cur = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(current + i));
+        __m128i nxt = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(next + i));
+
+        __m128i cur_mask[NUM_BASES];
+        __m128i next_mask[NUM_BASES];
+
+        for (int b = 0; b < NUM_BASES; ++b) {
+            cur_mask[b] = _mm_cmpeq_epi8(cur, codes[b]);
+            next_mask[b] = _mm_cmpeq_epi8(nxt, codes[b]);
+
+            histogram->current[b] += _mm_popcnt_u32(
+                _mm_movemask_epi8(cur_mask[b]));
+        }
+
+        for (int c = 0; c < NUM_BASES; ++c) {
+            for (int n = 0; n < NUM_BASES; ++n) {
+                histogram->pairs[c][n] += _mm_popcnt_u32(_mm_movemask_epi8(
+                    _mm_and_si128(cur_mask[c], next_mask[n])));
+            }
+        }
+    }
+}
+
+
+__attribute__((target("avx2,popcnt")))
+void count_pairs_avx2(const uint8_t *current, const uint8_t *next,
+                      uint32_t size, PairHistogram *histogram) {
+    __m256i codes[NUM_BASES];
+    for (int b = 0; b < NUM_BASES; ++b) {
+        codes[b] = _mm256_set1_epi8(b);
+    }
+
+    for (uint32_t i = 0; i < size; i += 32) {
+        __m256i cur = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(current + i));
+        __m256i nxt = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(next + i));
+
+        __m256i cur_mask[NUM_BASES];
+        __m256i next_mask[NUM_BASES];
+
+        for (int b = 0; b < NUM_BASES; ++b) {
+            cur_mask[b] = _mm256_cmpeq_epi8(cur, codes[b]);
+            next_mask[b] = _mm256_cmpeq_epi8(nxt, codes[b]);
+
+            histogram->current[b] += _mm_popcnt_u32(
+                _mm256_movemask_epi8(cur_mask[b]));
+        }
+
+        for (int c = 0; c < NUM_BASES; ++c) {
+            for (int n = 0; n < NUM_BASES; ++n) {
+                histogram->pairs[c][n] += _mm_popcnt_u32(_mm256_movemask_epi8(
+                    _mm256_and_si256(cur_mask[c], next_mask[n])));
+            }
+        }
+    }
+}
+
+#endif  // VOTE_KERNEL_X86
+
+
+struct KernelSelection {
+    kernel_function function;
+    const char *name;
+
+    KernelSelection(): function(count_pairs_scalar), name("scalar") {
+#ifdef VOTE_KERNEL_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2") &&
+            __builtin_cpu_supports("popcnt")) {
+            function = count_pairs_avx2;
+            name = "avx2";
+        } else if (__builtin_cpu_supports("sse4.2") &&
+                   __builtin_cpu_supports("popcnt")) {
+            function = count_pairs_sse42;
+            name = "sse4.2";
+        }
+#endif
+    }
+};
+
+
+const KernelSelection& get_kernel() {
+    static const KernelSelection selection;
+    return selection;
+}
+
+
+void pack_codes(const ExtensionSet& extensions, bool weighted,
+                VoteBuffer *pbuffer) {
+    auto& buffer = *pbuffer;
+
+    const char *arena = extensions.arena();
+    const uint32_t *offsets = extensions.offsets();
+    const uint32_t *lengths = extensions.lengths();
+    const uint32_t *cursors = extensions.cursors();
+    const uint64_t *dropped = extensions.dropped_bitmap();
+
+    uint32_t size = extensions.size();
+    uint32_t padded_size = (size + VECTOR_WIDTH - 1) / VECTOR_WIDTH *
+        VECTOR_WIDTH;
+
+    buffer.current.assign(padded_size, NO_BASE_CODE);
+    buffer.next.assign(padded_size, NO_BASE_CODE);
+
+    const uint8_t *quals = extensions.quality_arena();
+    if (weighted) {
+        buffer.current_weight.assign(padded_size, 0);
+        buffer.next_weight.assign(padded_size, 0);
+    }
+
+    for (uint32_t j = 0; j < size; ++j) {
+        if ((dropped[j >> 6] >> (j & 63)) & 1) {
+            continue;
+        }
+
+        uint32_t position = cursors[j];
+        const uint8_t *seq = reinterpret_cast<const uint8_t*>(
+            arena + offsets[j]);
+
+        if (position < lengths[j]) {
+            buffer.current[j] = BASE_CODES[seq[position]];
+        }
+
+        if (position + 1 < lengths[j]) {
+            buffer.next[j] = BASE_CODES[seq[position + 1]];
+        }
+
+        if (weighted && position < lengths[j]) {
+            const uint8_t *qual = quals + offsets[j];
+            buffer.current_weight[j] = quality_weight(qual[position]);
+
+            if (position + 1 < lengths[j]) {
+                buffer.next_weight[j] = quality_weight(qual[position + 1]);
+            }
+        }
+    }
+}
+
+
+// sums the packed weights into the scores of the current column and of the
+// next column grouped by the current base
+void sum_weights(const VoteBuffer& buffer, ColumnVotes *pvotes) {
+    auto& votes = *pvotes;
+    uint32_t size = buffer.current.size();
+
+    for (uint32_t j = 0; j < size; ++j) {
+        uint8_t current = buffer.current[j];
+        uint8_t next = buffer.next[j];
+
+        if (current < NUM_BASES) {
+            votes.current.score[current] += buffer.current_weight[j];
+
+            if (next < NUM_BASES) {
+                votes.next[current].score[next] += buffer.next_weight[j];
+            }
+        }
+    }
+}
+
+
+void count_columns(const ExtensionSet& extensions, VoteBuffer* pbuffer,
+                   ColumnVotes* pvotes) {
+    auto& votes = *pvotes;
+
+    bool weighted = get_vote_mode() == QUALITY_WEIGHTED_VOTE;
+    pack_codes(extensions, weighted, pbuffer);
+
+    PairHistogram histogram;
+    memset(&histogram, 0, sizeof(histogram));
+
+    get_kernel().function(pbuffer->current.data(), pbuffer->next.data(),
+                          pbuffer->current.size(), &histogram);
+
+    votes.current = BasesCounter();
+    for (int b = 0; b < NUM_BASES; ++b) {
+        votes.current.count[b] = histogram.current[b];
+    }
+    votes.current.count[BASE_N_IDX] = histogram.current[OTHER_BASE_CODE];
+
+    for (int c = 0; c < NUM_BASES; ++c) {
+        votes.next[c] = BasesCounter();
+        for (int n = 0; n < NUM_BASES; ++n) {
+            votes.next[c].count[n] = histogram.pairs[c][n];
+        }
+    }
+
+    if (weighted) {
+        sum_weights(*pbuffer, &votes);
+    } else {
+        std::copy(votes.current.count, votes.current.count + NUM_BASE_CODES,
+                  votes.current.score);
+        for (int c = 0; c < NUM_BASES; ++c) {
+            std::copy(votes.next[c].count, votes.next[c].count + NUM_BASE_CODES,
+                      votes.next[c].score);
+        }
+    }
+
+    votes.current.refresh_stats();
+    for (int c = 0; c < NUM_BASES; ++c) {
+        votes.next[c].refresh_stats();
+    }
+}
+
+
+const char *vote_kernel_name() {
+    return get_kernel().name;
+}
+
+
+}  // namespace bases
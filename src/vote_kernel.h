@@ -0,0 +1,113 @@
+/**
+ * @file vote_kernel.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the column vote kernel.
+ * @details Header file for the column vote kernel. The kernel computes the
+ * base histograms of the current and the next extension column in a single
+ * pass over packed base codes, using AVX2 or SSE4.2 when supported by the
+ * CPU.
+ */
+#ifndef VOTE_KERNEL_H
+#define VOTE_KERNEL_H
+
+#include <vector>
+#include <cstdint>
+
+#include "bases.h"
+#include "extension.h"
+
+
+using std::vector;
+
+
+/**
+ * @brief Code of a base which is not one of A, T, G or C
+ */
+#define OTHER_BASE_CODE BASE_N_IDX
+
+/**
+ * @brief Code used when there is no base at the position
+ */
+#define NO_BASE_CODE 5
+
+
+namespace bases {
+
+
+/**
+ * @brief Base histograms of two consecutive extension columns.
+ */
+struct ColumnVotes {
+    /**
+     * @brief Bases at the current position of every active extension.
+     */
+    BasesCounter current;
+
+    /**
+     * @brief Bases at the next position of the extensions whose current base
+     * has the given index, i.e. next[i] is the result of count_bases with
+     * offset 1 and a predicate accepting only base idx_to_base(i).
+     */
+    BasesCounter next[NUM_BASES];
+};
+
+
+/**
+ * @brief Reusable buffers holding packed base codes.
+ * @details Codes are in range [0, NUM_BASES) for bases A, T, G and C, or one
+ * of OTHER_BASE_CODE and NO_BASE_CODE. Buffers are padded with NO_BASE_CODE
+ * to a multiple of the widest vector register.
+ */
+struct VoteBuffer {
+    /**
+     * @brief Code of the base at the current position of each extension.
+     */
+    vector<uint8_t> current;
+
+    /**
+     * @brief Code of the base after the current position of each extension.
+     */
+    vector<uint8_t> next;
+
+    /**
+     * @brief Vote weight of the current base of each extension, filled only
+     * in the quality weighted vote.
+     */
+    vector<uint8_t> current_weight;
+
+    /**
+     * @brief Vote weight of the next base of each extension, filled only in
+     * the quality weighted vote.
+     */
+    vector<uint8_t> next_weight;
+};
+
+
+/**
+ * @brief Counts the bases of the current and the next column.
+ * @details Current and next bases of every active extension are packed into
+ * the buffer, which is then reduced by the widest kernel supported by the
+ * CPU. The kernel is selected once at runtime. In the quality weighted vote
+ * the scores are summed from the packed weights in a second scalar pass.
+ *
+ * @param extensions extension reads of one contig end
+ * @param pbuffer pointer to the reusable packing buffer
+ * @param pvotes pointer to the output histograms
+ */
+void count_columns(const ExtensionSet& extensions, VoteBuffer* pbuffer,
+                   ColumnVotes* pvotes);
+
+
+/**
+ * @brief Returns the name of the kernel selected for this CPU.
+ * @return One of "avx2", "sse4.2" or "scalar".
+ */
+const char *vote_kernel_name();
+
+
+}  // namespace bases
+
+
+#endif  // VOTE_KERNEL_H
@@ -0,0 +1,175 @@
+/**
+ * @file windows.cpp
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Implementation file for the windowed consensus functions.
+ * @details Implementation file for the windowed consensus functions. Window
+ * boundaries are mapped from the backbone onto the other sequences with the
+ * bit-parallel edit distance, one backbone segment at a time.
+ */
+#include <algorithm>
+#include <vector>
+#include <string>
+
+#include "windows.h"
+#include "edit_distance.h"
+
+
+#define MIN_WINDOW_OVERLAP 20
+#define WINDOW_OVERLAP_DIVISOR 10  // overlap is a tenth of the window
+#define SEGMENT_ERROR_RATE 0.4  // read to read divergence of long reads
+#define STITCH_ERROR_RATE 0.3  // consensus to consensus divergence
+#define MIN_ALIGNMENT_ERRORS 2
+
+
+namespace windows {
+
+
+uint32_t window_overlap(uint32_t window_len) {
+    return std::max<uint32_t>(MIN_WINDOW_OVERLAP,
+                              window_len / WINDOW_OVERLAP_DIVISOR);
+}
+
+
+// maximum edit distance accepted for an alignment of the given length
+static uint32_t max_errors(uint32_t len, double rate) {
+    return std::max<uint32_t>(MIN_ALIGNMENT_ERRORS, rate * len);
+}
+
+
+vector<vector<string>> split_windows(const vector<string>& sequences,
+                                     uint32_t window_len) {
+    vector<vector<string>> windows;
+
+    if (sequences.empty()) {
+        return windows;
+    }
+
+    uint32_t overlap = window_overlap(window_len);
+
+    auto backbone_it = std::max_element(sequences.begin(), sequences.end(),
+        [](const string& a, const string& b) {
+            return a.length() < b.length();
+        });
+    const string& backbone = *backbone_it;
+    uint32_t backbone_len = backbone.length();
+
+    // window k spans backbone bases [k * window_len, k * window_len +
+    // window_len + overlap), the last window ends at the backbone end
+    vector<uint32_t> starts;
+    vector<uint32_t> ends;
+    for (uint32_t start = 0; start == 0 || start + overlap < backbone_len;
+         start += window_len) {
+        starts.push_back(start);
+        ends.push_back(std::min(start + window_len + overlap, backbone_len));
+    }
+
+    // sorted backbone positions which have to be mapped onto every sequence
+    vector<uint32_t> breakpoints(starts);
+    breakpoints.insert(breakpoints.end(), ends.begin(), ends.end());
+    std::sort(breakpoints.begin(), breakpoints.end());
+    breakpoints.erase(std::unique(breakpoints.begin(), breakpoints.end()),
+                      breakpoints.end());
+
+    uint32_t num_windows = starts.size();
+    windows.resize(num_windows);
+
+    vector<int64_t> positions(breakpoints.size());
+
+    for (auto const& seq : sequences) {
+        bool is_backbone = &seq == &backbone;
+
+        // position of each breakpoint in the sequence, -1 if not reached
+        std::fill(positions.begin(), positions.end(), -1);
+        positions[0] = 0;
+
+        for (uint32_t b = 1; b < breakpoints.size(); ++b) {
+            if (is_backbone) {
+                positions[b] = breakpoints[b];
+                continue;
+            }
+
+            uint32_t from = breakpoints[b - 1];
+            uint32_t segment_len = breakpoints[b] - from;
+            uint32_t position = positions[b - 1];
+
+            edit_distance::PrefixAlignment alignment;
+            if (!edit_distance::align_prefix(
+                    backbone.data() + from, segment_len,
+                    seq.data() + position, seq.length() - position,
+                    max_errors(segment_len, SEGMENT_ERROR_RATE),
+                    &alignment)) {
+                break;
+            }
+
+            positions[b] = position + alignment.text_end;
+        }
+
+        for (uint32_t k = 0; k < num_windows; ++k) {
+            uint32_t begin_idx = std::lower_bound(breakpoints.begin(),
+                breakpoints.end(), starts[k]) - breakpoints.begin();
+            uint32_t end_idx = std::lower_bound(breakpoints.begin(),
+                breakpoints.end(), ends[k]) - breakpoints.begin();
+
+            if (positions[end_idx] < 0) {
+                break;
+            }
+
+            windows[k].emplace_back(seq, positions[begin_idx],
+                                    positions[end_idx] - positions[begin_idx]);
+        }
+    }
+
+    // keep the windows up to the first one with too low coverage
+    for (uint32_t k = 0; k < num_windows; ++k) {
+        if (windows[k].size() < MIN_WINDOW_COVERAGE) {
+            windows.resize(k);
+            break;
+        }
+    }
+
+    return windows;
+}
+
+
+string stitch_windows(const vector<string>& consensus, uint32_t window_len) {
+    string stitched;
+
+    if (consensus.empty()) {
+        return stitched;
+    }
+
+    uint32_t overlap = window_overlap(window_len);
+    stitched = consensus[0];
+
+    for (uint32_t k = 1; k < consensus.size(); ++k) {
+        const string& next = consensus[k];
+        uint32_t tail_len = std::min<uint32_t>(overlap,
+                                               consensus[k - 1].length());
+        tail_len = std::min<uint32_t>(tail_len, stitched.length());
+
+        if (tail_len == 0 || next.empty()) {
+            break;
+        }
+
+        // the tail of the previous window is the start of the next one
+        const char *tail = stitched.data() + stitched.length() - tail_len;
+
+        edit_distance::PrefixAlignment alignment;
+        if (!edit_distance::align_prefix(tail, tail_len, next.data(),
+                                         next.length(),
+                                         max_errors(tail_len,
+                                                    STITCH_ERROR_RATE),
+                                         &alignment)) {
+            break;
+        }
+
+        stitched.append(next, alignment.text_end, string::npos);
+    }
+
+    return stitched;
+}
+
+
+}  // namespace windows
@@ -0,0 +1,83 @@
+/**
+ * @file windows.h
+ * @copyright Coypright 2015 Marko Culinovic, Luka Sterbic
+ * @author Marko Culinovic <marko.culinovic@gmail.com>
+ * @author Luka Sterbic <luka.sterbic@gmail.com>
+ * @brief Header file for the windowed consensus functions.
+ * @details Header file for the windowed consensus functions. Long extension
+ * sequences are split into short overlapping windows whose consensus can be
+ * computed independently, the window consensus sequences are then stitched
+ * together. The cost of the consensus thus grows linearly with the extension
+ * length instead of with the size of a single alignment of full sequences.
+ */
+#ifndef WINDOWS_H
+#define WINDOWS_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+using std::vector;
+using std::string;
+
+
+/**
+ * @brief Minimum number of read segments in a window
+ */
+#define MIN_WINDOW_COVERAGE 2
+
+
+/**
+ * @brief Namespace for the windowed consensus functions
+ */
+namespace windows {
+
+
+/**
+ * @brief Returns the overlap of consecutive windows of the given length.
+ *
+ * @param window_len window length in bases
+ * @return Overlap length in bases.
+ */
+uint32_t window_overlap(uint32_t window_len);
+
+
+/**
+ * @brief Splits extension sequences into overlapping windows.
+ * @details The longest sequence is used as the backbone and cut into windows
+ * of window_len bases which overlap the next window by window_overlap bases.
+ * The window boundaries are mapped onto every other sequence by aligning the
+ * backbone segments between consecutive boundaries to the sequence, a
+ * sequence takes part in the windows it spans completely. Windows are
+ * returned up to the first window with fewer than MIN_WINDOW_COVERAGE
+ * segments.
+ *
+ * @param sequences extension sequences, all starting at the contig end
+ * @param window_len window length in bases, must be positive
+ *
+ * @return Read segments of each window.
+ */
+vector<vector<string>> split_windows(const vector<string>& sequences,
+                                     uint32_t window_len);
+
+
+/**
+ * @brief Stitches the consensus sequences of consecutive windows.
+ * @details The tail of the stitched sequence, of the length of the window
+ * overlap, is aligned to the start of the next window consensus which is then
+ * appended after the aligned bases. Stitching stops at the first window which
+ * does not align to the previous one.
+ *
+ * @param consensus consensus sequence of each window
+ * @param window_len window length used to split the sequences
+ *
+ * @return Consensus of the whole extension.
+ */
+string stitch_windows(const vector<string>& consensus, uint32_t window_len);
+
+
+}  // namespace windows
+
+
+#endif  // WINDOWS_H